@@ -0,0 +1,108 @@
+#include "container_printer.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+using container_printer::detail::simd::instruction_set;
+
+constexpr std::size_t element_count = 1'000'000;
+constexpr int repetitions = 20;
+
+const char* to_string(instruction_set set) noexcept
+{
+    switch (set) {
+        case instruction_set::scalar:
+            return "scalar";
+        case instruction_set::sse41:
+            return "sse4.1";
+        case instruction_set::avx2:
+            return "avx2";
+    }
+
+    return "unknown";
+}
+
+/**
+ * @brief Formats the vector with the given instruction set, and reports the best of several runs.
+ */
+template <typename IntegerType>
+std::string run(const char* name, const std::vector<IntegerType>& values, instruction_set set)
+{
+    std::string output;
+    output.reserve(values.size() * 24);
+
+    auto best = std::chrono::nanoseconds::max();
+    for (int repetition = 0; repetition < repetitions; ++repetition) {
+        output.clear();
+
+        const auto start = std::chrono::steady_clock::now();
+
+        container_printer::sinks::string_sink<char> sink{ output };
+        container_printer::detail::write_contiguous(
+            sink, values.data(), values.size(), ", ", container_printer::detail::float_spec{},
+            set);
+
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed));
+    }
+
+    const auto nanoseconds = static_cast<double>(best.count());
+    std::printf(
+        "%-28s %-8s %8.2f ns/element %10.1f MB/s\n", name, to_string(set),
+        nanoseconds / static_cast<double>(values.size()),
+        static_cast<double>(output.size()) / nanoseconds * 1000.0);
+
+    return output;
+}
+
+template <typename IntegerType>
+void compare(const char* name, IntegerType minimum, IntegerType maximum)
+{
+    std::mt19937_64 generator{ 2024 };
+    std::uniform_int_distribution<IntegerType> distribution{ minimum, maximum };
+
+    std::vector<IntegerType> values(element_count);
+    for (auto& value : values) {
+        value = distribution(generator);
+    }
+
+    const auto available = container_printer::detail::simd::active_instruction_set();
+    const auto expected = run(name, values, instruction_set::scalar);
+
+    for (const auto set : { instruction_set::sse41, instruction_set::avx2 }) {
+        if (static_cast<int>(set) > static_cast<int>(available)) {
+            continue;
+        }
+
+        if (run(name, values, set) != expected) {
+            std::printf("%-28s %-8s output differs from the scalar path!\n", name, to_string(set));
+        }
+    }
+
+    std::printf("\n");
+}
+} // namespace
+
+int main()
+{
+    compare<std::int32_t>("int32, uniform [-10^6, 10^6]", -1'000'000, 1'000'000);
+    compare<std::int32_t>("int32, small [-99, 99]", -99, 99);
+    compare<std::int32_t>(
+        "int32, full range", std::numeric_limits<std::int32_t>::min(),
+        std::numeric_limits<std::int32_t>::max());
+
+    compare<std::int64_t>("int64, uniform [-10^6, 10^6]", -1'000'000, 1'000'000);
+    compare<std::int64_t>("int64, small [-99, 99]", -99, 99);
+    compare<std::int64_t>(
+        "int64, full range", std::numeric_limits<std::int64_t>::min(),
+        std::numeric_limits<std::int64_t>::max());
+
+    return 0;
+}
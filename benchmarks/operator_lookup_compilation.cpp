@@ -0,0 +1,74 @@
+/**
+ * Compile-time benchmark for the overload resolution of the stream output operator.
+ *
+ * This translation unit is meant to be timed, rather than run. It inserts a thousand distinct
+ * types, each with an `operator<<` of its own, into a stream. Without
+ * `CONTAINER_PRINTER_USE_CONCEPTS`, the library's global operator is a candidate for every one of
+ * those insertions, and has to test each type against `traits::is_printable_as_container`. With
+ * it, the operator is only visible where `container_printer::operators` has been brought into
+ * scope, so that the other insertions never consider it:
+ *
+ *   cmake --build . --target operator_lookup_compilation_benchmark --clean-first
+ *   cmake --build . --target operator_lookup_compilation_benchmark_concepts --clean-first
+ *
+ * Both targets are built as C++20, so that the difference between them is down to the operator.
+ */
+
+#include "container_printer.h"
+
+#include <cstdio>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+constexpr int record_count = 1000;
+
+/**
+ * @brief A type that is printed through its own operator, like most types in a large code base.
+ */
+template <int Index> struct record
+{
+    int value = Index;
+
+    friend std::ostream& operator<<(std::ostream& stream, const record& instance)
+    {
+        return stream << '#' << instance.value;
+    }
+};
+
+template <int... Indices> std::size_t print_records(std::integer_sequence<int, Indices...>)
+{
+    std::ostringstream stream;
+    ((stream << record<Indices>{} << ' '), ...);
+
+    return stream.str().size();
+}
+
+std::size_t print_containers()
+{
+#if defined(CONTAINER_PRINTER_USE_CONCEPTS)
+    using namespace container_printer::operators;
+#endif
+
+    const std::map<std::string, std::vector<int>> container{ { "one", { 1 } },
+                                                             { "two", { 1, 2 } } };
+
+    std::ostringstream stream;
+    stream << container;
+
+    return stream.str().size();
+}
+} // namespace
+
+int main()
+{
+    const auto size =
+        print_records(std::make_integer_sequence<int, record_count>{}) + print_containers();
+    std::printf("Printed %zu characters.\n", size);
+
+    return 0;
+}
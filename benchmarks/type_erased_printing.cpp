@@ -0,0 +1,168 @@
+/**
+ * Benchmark for the type-erased printing engine.
+ *
+ * Prints containers of some thirty different types to a stream, much like a large program would,
+ * and reports the size of the executable along with the latency of printing each container with
+ * cold caches. Defining `CONTAINER_PRINTER_TYPE_ERASED` switches the stream output operator from
+ * a full copy of the printing code per container type to the shared, type-erased engine, so that
+ * the two can be compared:
+ *
+ *   cmake -DCMAKE_BUILD_TYPE=Release -DCONTAINER_PRINTER_BUILD_BENCHMARKS=ON ..
+ *   cmake --build . --target type_erased_printing_benchmark type_erased_printing_benchmark_erased
+ *   size type_erased_printing_benchmark type_erased_printing_benchmark_erased
+ */
+
+#include "container_printer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <list>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace
+{
+constexpr int repetitions = 200;
+
+/**
+ * @brief Larger than the last-level cache of most machines, so that sweeping over it evicts the
+ * code and data of the previous round of printing.
+ */
+constexpr std::size_t eviction_size = 64 * 1024 * 1024;
+
+template <typename Type> Type make_value(int index)
+{
+    if constexpr (std::is_same_v<Type, int>) {
+        return index;
+    } else if constexpr (std::is_same_v<Type, double>) {
+        return index * 0.25;
+    } else if constexpr (std::is_same_v<Type, std::string>) {
+        return "item-" + std::to_string(index);
+    } else if constexpr (std::is_same_v<Type, std::pair<int, std::string>>) {
+        return { index, make_value<std::string>(index) };
+    } else if constexpr (std::is_same_v<Type, std::tuple<int, double, std::string>>) {
+        return { index, make_value<double>(index), make_value<std::string>(index) };
+    } else {
+        return Type(static_cast<std::size_t>(index % 4), index);
+    }
+}
+
+template <typename ContainerType> ContainerType make_container()
+{
+    using value_type = typename ContainerType::value_type;
+
+    ContainerType container;
+    for (int index = 0; index < 16; ++index) {
+        container.insert(container.end(), make_value<value_type>(index));
+    }
+
+    return container;
+}
+
+template <typename ContainerType> ContainerType make_map()
+{
+    using mapped_type = typename ContainerType::mapped_type;
+
+    ContainerType container;
+    for (int index = 0; index < 16; ++index) {
+        container.emplace(make_value<std::string>(index), make_value<mapped_type>(index));
+    }
+
+    return container;
+}
+
+template <template <typename...> class ContainerTemplate>
+auto make_sequences()
+{
+    return std::make_tuple(
+        make_container<ContainerTemplate<int>>(), make_container<ContainerTemplate<double>>(),
+        make_container<ContainerTemplate<std::string>>(),
+        make_container<ContainerTemplate<std::pair<int, std::string>>>(),
+        make_container<ContainerTemplate<std::tuple<int, double, std::string>>>(),
+        make_container<ContainerTemplate<std::vector<int>>>());
+}
+
+auto make_all_containers()
+{
+    return std::tuple_cat(
+        make_sequences<std::vector>(), make_sequences<std::list>(), make_sequences<std::deque>(),
+        make_sequences<std::multiset>(),
+        std::make_tuple(
+            make_map<std::map<std::string, int>>(), make_map<std::map<std::string, double>>(),
+            make_map<std::map<std::string, std::vector<int>>>(),
+            make_map<std::map<std::string, std::string>>(),
+            make_map<std::unordered_map<std::string, int>>(),
+            make_map<std::unordered_map<std::string, std::vector<int>>>()));
+}
+
+std::size_t evict_caches(std::vector<char>& buffer)
+{
+    std::size_t sum = 0;
+    for (std::size_t index = 0; index < buffer.size(); index += 64) {
+        buffer[index] = static_cast<char>(buffer[index] + 1);
+        sum += static_cast<unsigned char>(buffer[index]);
+    }
+
+    return sum;
+}
+
+std::size_t file_size(const char* path)
+{
+    std::ifstream file{ path, std::ios::binary | std::ios::ate };
+    return file ? static_cast<std::size_t>(file.tellg()) : 0;
+}
+} // namespace
+
+int main(int /*argc*/, char* argv[])
+{
+    const auto containers = make_all_containers();
+    constexpr auto container_count = std::tuple_size_v<decltype(containers)>;
+
+    std::vector<char> eviction_buffer(eviction_size);
+    std::vector<double> samples;
+    std::size_t checksum = 0;
+
+    std::ostringstream stream;
+
+    for (int repetition = 0; repetition < repetitions; ++repetition) {
+        checksum += evict_caches(eviction_buffer);
+        stream.str({});
+
+        const auto start = std::chrono::steady_clock::now();
+        std::apply(
+            [&stream](const auto&... container) { ((stream << container), ...); }, containers);
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        samples.push_back(
+            std::chrono::duration<double, std::nano>(elapsed).count() / container_count);
+        checksum += stream.str().size();
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+#if defined(CONTAINER_PRINTER_TYPE_ERASED)
+    const char* const engine = "type-erased";
+#else
+    const char* const engine = "templated";
+#endif
+
+    std::printf("Engine:             %s\n", engine);
+    std::printf("Executable size:    %zu bytes\n", file_size(argv[0]));
+    std::printf("Containers printed: %zu types\n", container_count);
+    std::printf(
+        "Cold-cache latency: %.0f ns per container (median)\n", samples[samples.size() / 2]);
+    std::printf("                    %.0f ns per container (best)\n", samples.front());
+    std::printf("Checksum:           %zu\n", checksum);
+
+    return 0;
+}
@@ -0,0 +1,130 @@
+/**
+ * Compile-time benchmark for the printing of wide std::tuple<...> rows.
+ *
+ * This translation unit is meant to be timed, rather than run. It instantiates the printing of
+ * tuples of 32 to 64 elements, each with a couple of different element type mixes, for both a
+ * stream and a sink. Defining `CONTAINER_PRINTER_RECURSIVE_TUPLES` swaps the library's fold over
+ * the element indices for the recursive, one-instantiation-per-element handler that it replaced,
+ * so that the two can be compared:
+ *
+ *   cmake --build . --target wide_tuple_compilation_benchmark --clean-first
+ *   cmake --build . --target wide_tuple_compilation_benchmark_recursive --clean-first
+ *
+ * The recursive handler instantiates a `print(...)` function per element of every row type, where
+ * the fold instantiates one per row type; compare the symbol counts (`nm -C`) of the two objects
+ * as well as the build times.
+ */
+
+#include "container_printer.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <utility>
+
+namespace
+{
+/**
+ * @brief The type of the element at the given index of a row; the offset varies the mix of types
+ * from one row type to the next.
+ */
+template <std::size_t Index, std::size_t Offset> auto make_element()
+{
+    constexpr auto kind = (Index + Offset) % 4;
+
+    if constexpr (kind == 0) {
+        return static_cast<int>(Index);
+    } else if constexpr (kind == 1) {
+        return static_cast<double>(Index) / 4.0;
+    } else if constexpr (kind == 2) {
+        return "column";
+    } else {
+        return std::string{ "value" };
+    }
+}
+
+template <std::size_t Offset, std::size_t... Indices>
+auto make_row(std::index_sequence<Indices...>)
+{
+    return std::make_tuple(make_element<Indices, Offset>()...);
+}
+
+template <std::size_t Width, std::size_t Offset> auto make_row()
+{
+    return make_row<Offset>(std::make_index_sequence<Width>{});
+}
+
+#if defined(CONTAINER_PRINTER_RECURSIVE_TUPLES)
+/**
+ * @brief The recursive handler that used to print tuples, kept here for comparison only.
+ */
+template <typename TupleType, std::size_t Index, std::size_t Last> struct tuple_handler
+{
+    template <typename StreamType, typename FormatterType>
+    static void print(StreamType& stream, const TupleType& tuple, const FormatterType& formatter)
+    {
+        formatter.print_element(stream, std::get<Index>(tuple));
+        formatter.print_delimiter(stream);
+        tuple_handler<TupleType, Index + 1, Last>::print(stream, tuple, formatter);
+    }
+};
+
+template <typename TupleType, std::size_t Index> struct tuple_handler<TupleType, Index, Index>
+{
+    template <typename StreamType, typename FormatterType>
+    static void print(StreamType& stream, const TupleType& tuple, const FormatterType& formatter)
+    {
+        formatter.print_element(stream, std::get<Index>(tuple));
+    }
+};
+
+template <typename StreamType, typename... Types>
+void print_row(StreamType& stream, const std::tuple<Types...>& row)
+{
+    using formatter_type = container_printer::default_formatter<std::tuple<Types...>, StreamType>;
+
+    const formatter_type formatter{};
+
+    formatter.print_prefix(stream);
+    tuple_handler<std::tuple<Types...>, 0, sizeof...(Types) - 1>::print(stream, row, formatter);
+    formatter.print_suffix(stream);
+}
+#else
+template <typename StreamType, typename... Types>
+void print_row(StreamType& stream, const std::tuple<Types...>& row)
+{
+    using formatter_type = container_printer::default_formatter<std::tuple<Types...>, StreamType>;
+
+    container_printer::to_stream(stream, row, formatter_type{});
+}
+#endif
+
+template <std::size_t Width, std::size_t Offset> std::size_t print_rows()
+{
+    const auto row = make_row<Width, Offset>();
+
+    std::ostringstream stream;
+    print_row(stream, row);
+
+    std::string output;
+    container_printer::sinks::string_sink<char> sink{ output };
+    print_row(sink, row);
+
+    return stream.str().size() + output.size();
+}
+
+template <std::size_t... Widths> std::size_t print_all_rows()
+{
+    return (std::size_t{ 0 } + ... + (print_rows<Widths, 0>() + print_rows<Widths, 1>()));
+}
+} // namespace
+
+int main()
+{
+    const auto size = print_all_rows<32, 40, 48, 56, 64>();
+    std::printf("Printed %zu characters.\n", size);
+
+    return 0;
+}
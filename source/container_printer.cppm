@@ -0,0 +1,78 @@
+/**
+ * C++20 module interface unit for the container printer.
+ *
+ * Exports the `container_printer` namespace, with `to_stream(...)`, the formatters, sinks, and
+ * decorators, as well as the stream output operator and, where the standard library provides
+ * `std::format`, `fmt(...)` and the `std::formatter` specialization for the wrapper it returns.
+ * Build it through the `CONTAINER_PRINTER_BUILD_MODULE` option in `CMakeLists.txt`, and then:
+ *
+ *   import container_printer;
+ *
+ * The header remains available, and unchanged, for builds that don't use modules. Configuration
+ * macros, such as `CONTAINER_PRINTER_DISABLE_SIMD`, apply when the module itself is compiled.
+ */
+
+module;
+
+// The standard headers that `container_printer.h` and `container_printer_core.h` depend on are
+// included here, in the global module fragment, so that their declarations aren't attached to the
+// module. Their include guards then turn the headers' own includes into no-ops.
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iosfwd>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <locale>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if __has_include(<version>)
+#include <version>
+#endif
+
+#ifdef __cpp_lib_span
+#include <span>
+#endif
+
+#if defined(__cpp_lib_format)
+#include <format>
+#endif
+
+#if !defined(CONTAINER_PRINTER_DISABLE_SIMD) &&                                                    \
+    (defined(__x86_64__) || defined(__i386__) || defined(_M_X64))
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#include <immintrin.h>
+#endif
+
+export module container_printer;
+
+#define CONTAINER_PRINTER_MODULE
+#include "container_printer.h"
+#include "container_printer_format.h"
@@ -1,379 +1,653 @@
 #pragma once
 
-#include <algorithm>
+/**
+ * @brief The stream adapter for the container printer: the stream output operator, and the sinks
+ * and helpers that write to a `std::basic_ostream<...>`. The rest of the library lives in
+ * `container_printer_core.h`, which doesn't depend on the iostreams library.
+ */
+
+#include "container_printer_core.h"
+
 #include <cstddef>
 #include <iostream>
-#include <set>
+#include <locale>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <streambuf>
 #include <string>
-#include <tuple>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 
-namespace container_printer
+#if defined(CONTAINER_PRINTER_USE_CONCEPTS) && !defined(__cpp_concepts)
+#error "CONTAINER_PRINTER_USE_CONCEPTS requires a compiler with support for C++20 concepts."
+#endif
+
+CONTAINER_PRINTER_EXPORT namespace container_printer
 {
-namespace traits
+namespace detail
 {
 /**
- * @brief Base case for the testing of STL compatible container types.
+ * @brief Stream buffer that appends to a string, which keeps its capacity from one use to the next.
  */
-template <typename Type, typename = void> struct is_printable_as_container : public std::false_type
+template <typename CharacterType>
+class string_buffer : public std::basic_streambuf<CharacterType>
 {
-};
+  public:
+    using int_type = typename std::basic_streambuf<CharacterType>::int_type;
+    using traits_type = typename std::basic_streambuf<CharacterType>::traits_type;
 
-/**
- * @brief Specialization to ensure that Standard Library compatible containers that have
- * `begin()`, `end()`, and `empty()` member functions are treated as printable containers.
- */
-template <typename Type>
-struct is_printable_as_container<
-    Type, std::void_t<
-              typename Type::iterator, decltype(std::declval<Type&>().begin()),
-              decltype(std::declval<Type&>().end()), decltype(std::declval<Type&>().empty())>>
-    : public std::true_type
-{
-};
+    std::basic_string_view<CharacterType> view() const noexcept
+    {
+        return m_string;
+    }
 
-/**
- * @brief Specialization to treat std::pair<...> as a printable container type.
- */
-template <typename FirstType, typename SecondType>
-struct is_printable_as_container<std::pair<FirstType, SecondType>> : public std::true_type
-{
-};
+    void clear() noexcept
+    {
+        m_string.clear();
+    }
 
-/**
- * @brief Specialization to treat std::tuple<...> as a printable container type.
- */
-template <typename... Args>
-struct is_printable_as_container<std::tuple<Args...>> : public std::true_type
-{
-};
+  protected:
+    int_type overflow(int_type character) override
+    {
+        if (!traits_type::eq_int_type(character, traits_type::eof())) {
+            m_string.push_back(traits_type::to_char_type(character));
+        }
 
-/**
- * @brief Specialization to treat arrays as printable container types.
- */
-template <typename ArrayType, std::size_t ArraySize>
-struct is_printable_as_container<ArrayType[ArraySize]> : public std::true_type
-{
-};
+        return traits_type::not_eof(character);
+    }
 
-/**
- * @brief Narrow character array specialization meant to ensure that we print character arrays
- * as strings and not as delimiter containers of individual characters.
- */
-template <std::size_t ArraySize>
-struct is_printable_as_container<char[ArraySize]> : public std::false_type
-{
-};
+    std::streamsize xsputn(const CharacterType* data, std::streamsize size) override
+    {
+        m_string.append(data, static_cast<std::size_t>(size));
+        return size;
+    }
 
-/**
- * @brief Wide character array specialization meant to ensure that we print character arrays
- * as strings and not as delimiter containers of individual characters.
- */
-template <std::size_t ArraySize>
-struct is_printable_as_container<wchar_t[ArraySize]> : public std::false_type
-{
+  private:
+    std::basic_string<CharacterType> m_string;
 };
 
 /**
- * @brief String specialization meant to ensure that we treat strings as nothing more than
- * strings.
+ * @brief Lends out a thread-local output stream with the default format state, so that elements
+ * printed through their own `operator<<` don't each pay for the construction of a string stream.
+ *
+ * Should the thread-local stream already be in use further up the stack, as it would be if an
+ * element's `operator<<` printed a container of its own, then a fresh stream is lent out instead.
  */
-template <typename CharacterType, typename CharacterTraitsType, typename AllocatorType>
-struct is_printable_as_container<
-    std::basic_string<CharacterType, CharacterTraitsType, AllocatorType>> : public std::false_type
+template <typename CharacterType> class pooled_stream
 {
-};
+  public:
+    pooled_stream() : m_is_owner{ !is_in_use() }
+    {
+        if (!m_is_owner) {
+            m_fallback = std::make_unique<entry>();
+            return;
+        }
 
-/**
- * @brief Helper variable template.
- */
-template <typename Type>
-constexpr bool is_printable_as_container_v = is_printable_as_container<Type>::value;
-} // namespace traits
+        is_in_use() = true;
 
-namespace decorator
-{
-/**
- * @brief Struct to neatly wrap up all the additional characters we'll need in order to
- * print out the containers.
- */
-template <typename CharacterType> struct wrapper
-{
-    using type = CharacterType;
+        auto& stream = shared().stream;
+        stream.clear();
+        stream.flags(std::ios_base::dec | std::ios_base::skipws);
+        stream.precision(6);
+        stream.width(0);
+        stream.fill(stream.widen(' '));
 
-    const type* prefix;
-    const type* separator;
-    const type* suffix;
-};
+        if (stream.getloc() != std::locale{}) {
+            stream.imbue(std::locale{});
+        }
 
-/**
- * @brief Base definition for the delimiters. This probably won't ever get invoked.
- */
-template <typename /*ContainerType*/, typename CharacterType> struct delimiters
-{
-    using type = wrapper<CharacterType>;
+        shared().buffer.clear();
+    }
 
-    static const type values;
-};
+    ~pooled_stream() noexcept
+    {
+        if (m_is_owner) {
+            is_in_use() = false;
+        }
+    }
 
-/**
- * @brief Default narrow character specialization for any container type that isn't even
- * more specialized.
- */
-template <typename ContainerType> struct delimiters<ContainerType, char>
-{
-    using type = wrapper<char>;
+    pooled_stream(const pooled_stream&) = delete;
+    pooled_stream& operator=(const pooled_stream&) = delete;
 
-    static constexpr type values = { "[", ", ", "]" };
-};
+    std::basic_ostream<CharacterType>& stream() noexcept
+    {
+        return current().stream;
+    }
 
-/**
- * @brief Default wide character specialization for any container type that isn't even
- * more specialized.
- */
-template <typename ContainerType> struct delimiters<ContainerType, wchar_t>
-{
-    using type = wrapper<wchar_t>;
+    /**
+     * @returns Everything written to the stream so far.
+     */
+    std::basic_string_view<CharacterType> view() const noexcept
+    {
+        return m_is_owner ? shared().buffer.view() : m_fallback->buffer.view();
+    }
 
-    static constexpr type values = { L"[", L", ", L"]" };
-};
+  private:
+    struct entry
+    {
+        string_buffer<CharacterType> buffer;
+        std::basic_ostream<CharacterType> stream{ &buffer };
+    };
 
-/**
- * @brief Narrow character specialization for std::set<...> instances.
- */
-template <typename DataType, typename ComparatorType, typename AllocatorType>
-struct delimiters<std::set<DataType, ComparatorType, AllocatorType>, char>
-{
-    static constexpr wrapper<char> values = { "{", ", ", "}" };
-};
+    static entry& shared()
+    {
+        thread_local entry pooled;
+        return pooled;
+    }
 
-/**
- * @brief Wide character specialization for std::set<...> instances.
- */
-template <typename DataType, typename ComparatorType, typename AllocatorType>
-struct delimiters<std::set<DataType, ComparatorType, AllocatorType>, wchar_t>
-{
-    static constexpr wrapper<wchar_t> values = { L"{", L", ", L"}" };
-};
+    static bool& is_in_use() noexcept
+    {
+        thread_local bool flag = false;
+        return flag;
+    }
 
-/**
- * @brief Narrow character specialization for std::multiset<...> instances.
- */
-template <typename DataType, typename ComparatorType, typename AllocatorType>
-struct delimiters<std::multiset<DataType, ComparatorType, AllocatorType>, char>
-{
-    static constexpr wrapper<char> values = { "{", ", ", "}" };
-};
+    entry& current() noexcept
+    {
+        return m_is_owner ? shared() : *m_fallback;
+    }
 
-/**
- * @brief Wide character specialization for std::multiset<...> instances.
- */
-template <typename DataType, typename ComparatorType, typename AllocatorType>
-struct delimiters<std::multiset<DataType, ComparatorType, AllocatorType>, wchar_t>
-{
-    static constexpr wrapper<wchar_t> values = { L"{", L", ", L"}" };
+    bool m_is_owner;
+    std::unique_ptr<entry> m_fallback;
 };
 
 /**
- * @brief Narrow character specialization for std::pair<...> instances.
+ * @brief Formats values that have no native representation through their own `operator<<`.
  */
-template <typename FirstType, typename SecondType>
-struct delimiters<std::pair<FirstType, SecondType>, char>
+template <typename CharacterType> struct stream_formatter
 {
-    static constexpr wrapper<char> values = { "(", ", ", ")" };
-};
+    /**
+     * @brief Formats the value through a pooled, thread-local stream, with the default format
+     * state, and writes the result to the sink.
+     */
+    template <typename SinkType, typename Type> static void write(SinkType& sink, const Type& value)
+    {
+        pooled_stream<CharacterType> pooled;
+        pooled.stream() << value;
 
-/**
- * @brief Wide character specialization for std::pair<...> instances.
- */
-template <typename FirstType, typename SecondType>
-struct delimiters<std::pair<FirstType, SecondType>, wchar_t>
-{
-    static constexpr wrapper<wchar_t> values = { L"(", L", ", L")" };
-};
+        const auto view = pooled.view();
+        sink.write(view.data(), view.size());
+    }
 
-/**
- * @brief Narrow character specialization for std::tuple<...> instances.
- */
-template <typename... DataType> struct delimiters<std::tuple<DataType...>, char>
-{
-    static constexpr wrapper<char> values = { "<", ", ", ">" };
-};
+    /**
+     * @brief Formats the value through a string stream that carries the format flags of the
+     * originating stream, if there is one, and writes the result to the sink. The string stream is
+     * created on first use, and kept in `state` for subsequent values.
+     */
+    template <typename SinkType, typename Type>
+    static void write_like(
+        SinkType& sink, const std::basic_ios<CharacterType>* origin, std::shared_ptr<void>& state,
+        const Type& value)
+    {
+        using stream_type = std::basic_ostringstream<CharacterType>;
 
-/**
- * @brief Wide character specialization for std::tuple<...> instances.
- */
-template <typename... DataType> struct delimiters<std::tuple<DataType...>, wchar_t>
-{
-    static constexpr wrapper<wchar_t> values = { L"<", L", ", L">" };
+        if (!state) {
+            auto stream = std::make_shared<stream_type>();
+
+            if (origin) {
+                stream->copyfmt(*origin);
+                stream->tie(nullptr);
+                stream->exceptions(std::ios_base::goodbit);
+            }
+
+            state = std::move(stream);
+        }
+
+        auto& stream = *static_cast<stream_type*>(state.get());
+        stream.str({});
+        stream.clear();
+        stream << value;
+
+        const auto& string = stream.str();
+        sink.write(string.data(), string.size());
+    }
 };
-} // namespace decorator
+} // namespace detail
 
+namespace sinks
+{
 /**
- * @brief Default container formatter that will be used to print prefix, element, separator, and
- * suffix strings to an output stream.
+ * @brief Sink that collects output in a fixed-size block and hands full blocks to the stream's
+ * underlying `std::basic_streambuf<...>` in a single `sputn(...)` call.
+ *
+ * Elements without a native representation are still inserted through the stream itself, so that
+ * any stream state (flags, precision, locale) continues to apply to them.
  */
-template <typename ContainerType, typename StreamType> struct default_formatter
+template <typename CharacterType, typename CharacterTraitsType = std::char_traits<CharacterType>>
+class ostream_sink
+    : public sink_base<ostream_sink<CharacterType, CharacterTraitsType>, CharacterType>
 {
-    static constexpr auto decorators = container_printer::decorator::delimiters<
-        ContainerType, typename StreamType::char_type>::values;
+  public:
+    using stream_type = std::basic_ostream<CharacterType, CharacterTraitsType>;
+
+    static constexpr std::size_t block_size = 2048;
+
+    explicit ostream_sink(stream_type& stream)
+        : m_stream{ stream },
+          m_has_plain_integers{ has_plain_integers(stream) },
+          m_has_plain_floats{ has_plain_floats(stream) },
+          m_has_utf8_text{ detail::has_utf8_text<CharacterType>(stream.getloc()) },
+          m_is_writable{ stream.good() }
+    {
+    }
+
+    ~ostream_sink() noexcept
+    {
+        try {
+            flush();
+        } catch (...) {
+        }
+    }
+
+    ostream_sink(const ostream_sink&) = delete;
+    ostream_sink& operator=(const ostream_sink&) = delete;
+
+    using sink_base<ostream_sink, CharacterType>::write;
+
+    void put(CharacterType character)
+    {
+        if (m_size == block_size) {
+            drain();
+        }
+
+        m_buffer[m_size++] = character;
+    }
+
+    void write(const CharacterType* data, std::size_t size)
+    {
+        if (size > block_size - m_size) {
+            drain();
+
+            if (size >= block_size) {
+                commit(data, size);
+                return;
+            }
+        }
+
+        CharacterTraitsType::copy(m_buffer.data() + m_size, data, size);
+        m_size += size;
+    }
+
+    /**
+     * @brief Hands any buffered output to the stream, and then sets `badbit` on the stream if any
+     * of the output, since the last flush, couldn't be written.
+     */
+    void flush()
+    {
+        drain();
+
+        if (m_has_failed) {
+            m_has_failed = false;
+            m_stream.setstate(std::ios_base::badbit);
+        }
+    }
+
+    stream_type& stream() noexcept
+    {
+        return m_stream;
+    }
+
+    bool has_plain_integers() const noexcept
+    {
+        return m_has_plain_integers;
+    }
+
+    bool has_plain_floats() const noexcept
+    {
+        return m_has_plain_floats;
+    }
 
-    static void print_prefix(StreamType& stream) noexcept
+    bool has_utf8_text() const noexcept
     {
-        stream << decorators.prefix;
+        return m_has_utf8_text;
     }
 
-    template <typename ElementType>
-    static void print_element(StreamType& stream, const ElementType& element) noexcept
+    int float_precision() const noexcept
     {
-        stream << element;
+        return static_cast<int>(m_stream.precision());
     }
 
-    static void print_delimiter(StreamType& stream) noexcept
+    template <typename Type> void insert_formatted(const Type& value)
     {
-        stream << decorators.separator;
+        flush();
+        m_stream << value;
+
+        m_is_writable = m_stream.good();
     }
 
-    static void print_suffix(StreamType& stream) noexcept
+    /**
+     * @returns True if the stream's state allows integers to be written with the locale-free
+     * conversion.
+     */
+    static bool has_plain_integers(const stream_type& stream)
     {
-        stream << decorators.suffix;
+        constexpr auto relevant_flags =
+            std::ios_base::oct | std::ios_base::hex | std::ios_base::showpos;
+
+        return (stream.flags() & relevant_flags) == 0 && stream.getloc() == std::locale::classic();
+    }
+
+    /**
+     * @returns True if the stream's state allows floating-point values to be written with the
+     * locale-free conversion.
+     */
+    static bool has_plain_floats(const stream_type& stream)
+    {
+        constexpr auto relevant_flags = std::ios_base::floatfield | std::ios_base::showpoint |
+                                        std::ios_base::showpos | std::ios_base::uppercase;
+
+        return (stream.flags() & relevant_flags) == 0 && stream.precision() >= 0 &&
+               stream.getloc() == std::locale::classic();
     }
+
+  private:
+    void drain()
+    {
+        if (m_size == 0) {
+            return;
+        }
+
+        const auto size = m_size;
+        m_size = 0;
+
+        commit(m_buffer.data(), size);
+    }
+
+    /**
+     * @brief Writes straight to the stream buffer. A failure is only recorded here, and reflected
+     * in the stream state by the next `flush()`; nothing more is written in the meantime.
+     */
+    void commit(const CharacterType* data, std::size_t size)
+    {
+        if (!m_is_writable) {
+            return;
+        }
+
+        auto* const buffer = m_stream.rdbuf();
+        if (buffer == nullptr ||
+            buffer->sputn(data, static_cast<std::streamsize>(size)) !=
+                static_cast<std::streamsize>(size)) {
+            m_is_writable = false;
+            m_has_failed = true;
+        }
+    }
+
+    stream_type& m_stream;
+    std::array<CharacterType, block_size> m_buffer;
+    std::size_t m_size = 0;
+    bool m_has_plain_integers;
+    bool m_has_plain_floats;
+    bool m_has_utf8_text;
+    bool m_is_writable;
+    bool m_has_failed = false;
 };
+} // namespace sinks
+
+namespace detail
+{
+template <typename CharacterType>
+sink_profile<CharacterType> make_stream_profile(const std::basic_ostream<CharacterType>& stream)
+{
+    using sink_type = sinks::ostream_sink<CharacterType>;
+
+    sink_profile<CharacterType> profile;
+    profile.has_plain_integers = sink_type::has_plain_integers(stream);
+    profile.has_plain_floats = sink_type::has_plain_floats(stream);
+    profile.has_utf8_text = detail::has_utf8_text<CharacterType>(stream.getloc());
+    profile.float_precision = static_cast<int>(stream.precision());
+    profile.origin = &stream;
+
+    return profile;
+}
 
 /**
- * @brief Helper function to determine if a container is empty.
+ * @brief Writes the prefix of a container, padded to the given field width with the stream's fill
+ * character, just as inserting the prefix into the stream would have.
  */
-template <typename ContainerType> bool is_empty(const ContainerType& container) noexcept
-{
-    return container.empty();
+template <typename SinkType, typename CharacterTraitsType>
+void write_padded_prefix(
+    SinkType& sink, const std::basic_ios<typename SinkType::char_type, CharacterTraitsType>& stream,
+    std::basic_string_view<typename SinkType::char_type> prefix, std::streamsize width)
+{
+    const auto padding = width > static_cast<std::streamsize>(prefix.size())
+                             ? static_cast<std::size_t>(width) - prefix.size()
+                             : std::size_t{ 0 };
+
+    const auto is_left_aligned =
+        (stream.flags() & std::ios_base::adjustfield) == std::ios_base::left;
+
+    const auto pad = [&sink, padding, fill = stream.fill()] {
+        for (std::size_t index = 0; index < padding; ++index) {
+            sink.put(fill);
+        }
+    };
+
+    if (!is_left_aligned) {
+        pad();
+    }
+
+    sink.write(prefix.data(), prefix.size());
+
+    if (is_left_aligned) {
+        pad();
+    }
 }
 
 /**
- * @brief Helper function to test arrays for emptiness.
+ * @brief Prints a container to a sink that writes to the given stream. A non-zero field width
+ * applies to the first insertion only, which is the prefix; the prefix is then padded here, and
+ * the rest of the container is printed without it.
  */
-template <typename ArrayType, std::size_t ArraySize>
-constexpr bool is_empty(const ArrayType (&)[ArraySize]) noexcept
-{
-    return ArraySize == 0;
+template <typename SinkType, typename CharacterTraitsType, typename ContainerType>
+void print_to_sink(
+    SinkType& sink, const std::basic_ios<typename SinkType::char_type, CharacterTraitsType>& stream,
+    std::streamsize width, const ContainerType& container, const format_options& options,
+    const decorator::wrapper<typename SinkType::char_type>& delimiters)
+{
+    if (width != 0) {
+        write_padded_prefix(sink, stream, delimiters.prefix, width);
+
+#if defined(CONTAINER_PRINTER_TYPE_ERASED)
+        erased::write_container(sink, container, options, delimiters, false);
+#else
+        auto remainder = delimiters;
+        remainder.prefix = {};
+
+        to_stream(
+            sink, container, default_formatter<ContainerType, SinkType>{ options, remainder });
+#endif
+        return;
+    }
+
+#if defined(CONTAINER_PRINTER_TYPE_ERASED)
+    erased::write_container(sink, container, options, delimiters);
+#else
+    to_stream(sink, container, default_formatter<ContainerType, SinkType>{ options, delimiters });
+#endif
 }
 
 /**
- * @brief Recursive tuple handler struct meant to unpack and print std::tuple<...> elements.
+ * @brief Formats the entire container into a thread-local buffer, and then writes the buffer to
+ * the stream with a single call to `sputn(...)`.
  */
-template <typename TupleType, std::size_t Index, std::size_t Last> struct tuple_handler
+template <typename CharacterType, typename ContainerType>
+void print_atomically(
+    std::basic_ostream<CharacterType>& stream, std::streamsize width,
+    const ContainerType& container, const format_options& options,
+    const decorator::wrapper<CharacterType>& delimiters)
 {
-    template <typename StreamType, typename FormatterType>
-    static void
-    print(StreamType& stream, const TupleType& container, const FormatterType& formatter)
-    {
-        stream << std::get<Index>(container);
-        formatter.print_delimiter(stream);
-        tuple_handler<TupleType, Index + 1, Last>::print(stream, container, formatter);
+    using sink_type = profiled_sink<CharacterType, true>;
+
+    scratch_string<CharacterType> scratch;
+    auto& text = scratch.get();
+
+    const auto profile = make_stream_profile(stream);
+
+    sink_type sink{ text, profile };
+    print_to_sink(sink, stream, width, container, options, delimiters);
+
+    if (!stream.good()) {
+        return;
     }
-};
+
+    auto* const buffer = stream.rdbuf();
+    if (buffer == nullptr ||
+        buffer->sputn(text.data(), static_cast<std::streamsize>(text.size())) !=
+            static_cast<std::streamsize>(text.size())) {
+        stream.setstate(std::ios_base::badbit);
+    }
+}
 
 /**
- * @brief Specialization of tuple handler to deal with empty std::tuple<...> objects.
+ * @brief Prints a container to a `std::basic_ostream<...>`, routing the output through an
+ * `ostream_sink<...>`. Streams of all kinds share this function, so that an `std::ostringstream`
+ * and an `std::ofstream` don't each need their own copy of the printing code; it is also what the
+ * companion library in `container_printer_extern.h` instantiates ahead of time.
+ *
+ * As with any formatted output function, a sentry is taken, but only once for the entire
+ * container; the delimiters and elements are then handed to the stream buffer directly, and the
+ * stream state is updated once, at the end.
  */
-template <typename TupleType>
-struct tuple_handler<TupleType, 0, std::numeric_limits<std::size_t>::max()>
+template <typename CharacterType, typename CharacterTraitsType, typename ContainerType>
+void print_to_ostream(
+    std::basic_ostream<CharacterType, CharacterTraitsType>& stream, const ContainerType& container,
+    const format_options& options, const decorator::wrapper<CharacterType>& delimiters)
 {
-    template <typename StreamType, typename FormatterType>
-    static void print(
-        StreamType& /*stream*/, const TupleType& /*tuple*/,
-        const FormatterType& /*formatter*/) noexcept
-    {
+    using stream_type = std::basic_ostream<CharacterType, CharacterTraitsType>;
+    using sink_type = sinks::ostream_sink<CharacterType, CharacterTraitsType>;
+
+    const typename stream_type::sentry sentry{ stream };
+    if (!sentry) {
+        return;
     }
-};
+
+    const auto width = stream.width(0);
+
+    if constexpr (std::is_same_v<CharacterTraitsType, std::char_traits<CharacterType>>) {
+        if (options.atomic_write) {
+            print_atomically(stream, width, container, options, delimiters);
+            return;
+        }
+    }
+
+    sink_type sink{ stream };
+    print_to_sink(sink, stream, width, container, options, delimiters);
+    sink.flush();
+}
 
 /**
- * @brief Specialization of tuple handler to deal with the last element in the std::tuple<...>
- * object.
+ * @brief Prints a container to a stream or sink, forwarding any kind of `std::basic_ostream<...>`
+ * to `print_to_ostream(...)`.
  */
-template <typename TupleType, std::size_t Index> struct tuple_handler<TupleType, Index, Index>
-{
-    template <typename StreamType, typename FormatterType>
-    static void
-    print(StreamType& stream, const TupleType& tuple, const FormatterType& /*formatter*/) noexcept
-    {
-        stream << std::get<Index>(tuple);
+template <typename StreamType, typename ContainerType>
+void print_to_stream(
+    StreamType& stream, const ContainerType& container, const format_options& options = {},
+    const decorator::wrapper<typename StreamType::char_type>& delimiters =
+        decorator::delimiters<ContainerType, typename StreamType::char_type>::values)
+{
+    using char_type = typename StreamType::char_type;
+    using traits_type = typename StreamType::traits_type;
+    using ostream_type = std::basic_ostream<char_type, traits_type>;
+
+    if constexpr (std::is_base_of_v<ostream_type, StreamType>) {
+        print_to_ostream(static_cast<ostream_type&>(stream), container, options, delimiters);
+    } else {
+        to_stream(
+            stream, container,
+            default_formatter<ContainerType, StreamType>{ options, delimiters });
     }
-};
+}
+} // namespace detail
 
 /**
- * @brief Overload to deal with std::tuple<...> objects.
+ * @brief Overload of the stream output operator for containers paired with format options.
  */
-template <typename StreamType, typename FormatterType, typename... TupleArgs>
-static StreamType& to_stream(
-    StreamType& stream, const std::tuple<TupleArgs...>& container, const FormatterType& formatter)
+template <typename CharacterType, typename CharacterTraitsType, typename ContainerType>
+std::basic_ostream<CharacterType, CharacterTraitsType>& operator<<(
+    std::basic_ostream<CharacterType, CharacterTraitsType>& stream,
+    const options_wrapper<ContainerType>& wrapper)
 {
-    using ContainerType = std::decay_t<decltype(container)>;
-
-    formatter.print_prefix(stream);
-    tuple_handler<ContainerType, 0, sizeof...(TupleArgs) - 1>::print(stream, container, formatter);
-    formatter.print_suffix(stream);
+    detail::print_to_stream(stream, wrapper.container, wrapper.options);
 
     return stream;
 }
 
 /**
- * @brief Overload to handle std::pair<...> objects.
+ * @brief Overload of the stream output operator for containers paired with runtime delimiters.
  */
-template <typename FirstType, typename SecondType, typename StreamType, typename FormatterType>
-static StreamType& to_stream(
-    StreamType& stream, const std::pair<FirstType, SecondType>& container,
-    const FormatterType& formatter)
+template <typename CharacterType, typename CharacterTraitsType, typename ContainerType>
+std::basic_ostream<CharacterType, CharacterTraitsType>& operator<<(
+    std::basic_ostream<CharacterType, CharacterTraitsType>& stream,
+    const delimiters_wrapper<ContainerType, CharacterType>& wrapper)
 {
-    formatter.print_prefix(stream);
-    formatter.print_element(stream, container.first);
-    formatter.print_delimiter(stream);
-    formatter.print_element(stream, container.second);
-    formatter.print_suffix(stream);
+    detail::print_to_stream(stream, wrapper.container, wrapper.options, wrapper.delimiters);
 
     return stream;
 }
 
 /**
- * @brief Overload to handle containers that support the notion of "emptiness,"
- * and forward-iterability.
+ * @brief Overload of the stream output operator for static strings, which writes the entire string
+ * at once.
  */
-template <typename ContainerType, typename StreamType, typename FormatterType>
-static StreamType&
-to_stream(StreamType& stream, const ContainerType& container, const FormatterType& formatter)
+template <typename CharacterType, typename CharacterTraitsType, std::size_t Capacity>
+std::basic_ostream<CharacterType, CharacterTraitsType>& operator<<(
+    std::basic_ostream<CharacterType, CharacterTraitsType>& stream,
+    const static_string<CharacterType, Capacity>& string)
 {
-    formatter.print_prefix(stream);
-
-    if (is_empty(container)) {
-        formatter.print_suffix(stream);
-
-        return stream;
-    }
-
-    auto begin = std::begin(container);
-    formatter.print_element(stream, *begin);
+    return stream.write(string.c_str(), static_cast<std::streamsize>(string.size()));
+}
 
-    std::advance(begin, 1);
+#if defined(CONTAINER_PRINTER_USE_CONCEPTS)
+namespace traits
+{
+/**
+ * @brief Concept for printable containers. Only class and array types are ever tested against the
+ * full trait, so that the many insertions of scalars into streams are rejected at a glance.
+ */
+template <typename Type>
+concept printable_container =
+    (std::is_class_v<Type> || std::is_array_v<Type>) && is_printable_as_container_v<Type>;
 
-    std::for_each(begin, std::end(container), [&stream, &formatter](const auto& element) {
-        formatter.print_delimiter(stream);
-        formatter.print_element(stream, element);
-    });
+/**
+ * @brief Concept for the streams and sinks that containers can be printed to.
+ */
+template <typename Type>
+concept output_stream = requires { typename Type::char_type; };
+} // namespace traits
 
-    formatter.print_suffix(stream);
+/**
+ * @brief Home of the stream output operator when `CONTAINER_PRINTER_USE_CONCEPTS` is defined. Bring
+ * it into scope only where containers are printed, as in:
+ *
+ * `using namespace container_printer::operators;`
+ */
+namespace operators
+{
+/**
+ * @brief Overload of the stream output operator for compatible containers.
+ */
+template <traits::printable_container ContainerType, traits::output_stream StreamType>
+StreamType& operator<<(StreamType& stream, const ContainerType& container)
+{
+    detail::print_to_stream(stream, container);
 
     return stream;
 }
+} // namespace operators
+#endif
 } // namespace container_printer
 
+#if !defined(CONTAINER_PRINTER_USE_CONCEPTS)
 /**
  * @brief Overload of the stream output operator for compatible containers.
  */
-template <typename ContainerType, typename StreamType>
+CONTAINER_PRINTER_EXPORT template <typename ContainerType, typename StreamType>
 auto operator<<(StreamType& stream, const ContainerType& container) -> std::enable_if_t<
     container_printer::traits::is_printable_as_container_v<ContainerType>, StreamType&>
 {
-    using formatter_type = container_printer::default_formatter<ContainerType, StreamType>;
-    container_printer::to_stream(stream, container, formatter_type{});
+    container_printer::detail::print_to_stream(stream, container);
 
     return stream;
 }
+#endif
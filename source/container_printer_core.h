@@ -0,0 +1,4510 @@
+#pragma once
+
+/**
+ * @brief The core of the container printer: the traits, delimiters, formatters, and traversal,
+ * along with the sinks that write to strings and buffers. This header doesn't depend on the
+ * iostreams library; include `container_printer.h` for the stream output operator.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iosfwd>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if __has_include(<version>)
+#include <version>
+#endif
+
+#ifdef __cpp_lib_span
+#include <span>
+#endif
+
+#if !defined(CONTAINER_PRINTER_DISABLE_SIMD) &&                                                    \
+    (defined(__x86_64__) || defined(__i386__) || defined(_M_X64))
+#if defined(__GNUC__) || defined(__clang__)
+#define CONTAINER_PRINTER_HAS_X86_SIMD 1
+#define CONTAINER_PRINTER_TARGET(features) __attribute__((target(features)))
+#elif defined(_MSC_VER)
+#define CONTAINER_PRINTER_HAS_X86_SIMD 1
+#define CONTAINER_PRINTER_TARGET(features)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(CONTAINER_PRINTER_HAS_X86_SIMD)
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CONTAINER_PRINTER_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define CONTAINER_PRINTER_NOINLINE __declspec(noinline)
+#else
+#define CONTAINER_PRINTER_NOINLINE
+#endif
+
+#if defined(CONTAINER_PRINTER_MODULE)
+#define CONTAINER_PRINTER_EXPORT export
+#else
+#define CONTAINER_PRINTER_EXPORT
+#endif
+
+CONTAINER_PRINTER_EXPORT namespace container_printer
+{
+namespace traits
+{
+/**
+ * @brief Base case for the testing of STL compatible container types.
+ */
+template <typename Type, typename = void> struct is_printable_as_container : public std::false_type
+{
+};
+
+/**
+ * @brief Specialization to ensure that Standard Library compatible containers that have
+ * `begin()`, `end()`, and `empty()` member functions are treated as printable containers.
+ */
+template <typename Type>
+struct is_printable_as_container<
+    Type, std::void_t<
+              typename Type::iterator, decltype(std::declval<Type&>().begin()),
+              decltype(std::declval<Type&>().end()), decltype(std::declval<Type&>().empty())>>
+    : public std::true_type
+{
+};
+
+/**
+ * @brief Specialization to treat std::pair<...> as a printable container type.
+ */
+template <typename FirstType, typename SecondType>
+struct is_printable_as_container<std::pair<FirstType, SecondType>> : public std::true_type
+{
+};
+
+/**
+ * @brief Specialization to treat std::tuple<...> as a printable container type.
+ */
+template <typename... Args>
+struct is_printable_as_container<std::tuple<Args...>> : public std::true_type
+{
+};
+
+/**
+ * @brief Specialization to treat arrays as printable container types.
+ */
+template <typename ArrayType, std::size_t ArraySize>
+struct is_printable_as_container<ArrayType[ArraySize]> : public std::true_type
+{
+};
+
+/**
+ * @brief Narrow character array specialization meant to ensure that we print character arrays
+ * as strings and not as delimiter containers of individual characters.
+ */
+template <std::size_t ArraySize>
+struct is_printable_as_container<char[ArraySize]> : public std::false_type
+{
+};
+
+/**
+ * @brief Wide character array specialization meant to ensure that we print character arrays
+ * as strings and not as delimiter containers of individual characters.
+ */
+template <std::size_t ArraySize>
+struct is_printable_as_container<wchar_t[ArraySize]> : public std::false_type
+{
+};
+
+/**
+ * @brief UTF-16 character array specialization; see the narrow character specialization.
+ */
+template <std::size_t ArraySize>
+struct is_printable_as_container<char16_t[ArraySize]> : public std::false_type
+{
+};
+
+/**
+ * @brief UTF-32 character array specialization; see the narrow character specialization.
+ */
+template <std::size_t ArraySize>
+struct is_printable_as_container<char32_t[ArraySize]> : public std::false_type
+{
+};
+
+#if defined(__cpp_char8_t)
+/**
+ * @brief UTF-8 character array specialization; see the narrow character specialization.
+ */
+template <std::size_t ArraySize>
+struct is_printable_as_container<char8_t[ArraySize]> : public std::false_type
+{
+};
+#endif
+
+/**
+ * @brief String specialization meant to ensure that we treat strings as nothing more than
+ * strings.
+ */
+template <typename CharacterType, typename CharacterTraitsType, typename AllocatorType>
+struct is_printable_as_container<
+    std::basic_string<CharacterType, CharacterTraitsType, AllocatorType>> : public std::false_type
+{
+};
+
+/**
+ * @brief Helper variable template.
+ */
+template <typename Type>
+constexpr bool is_printable_as_container_v = is_printable_as_container<Type>::value;
+
+/**
+ * @brief Base case for the detection of output sinks; see `sinks::sink_base`.
+ */
+template <typename Type, typename = void> struct is_sink : public std::false_type
+{
+};
+
+/**
+ * @brief Specialization to detect types that derive from `sinks::sink_base<...>`.
+ */
+template <typename Type>
+struct is_sink<Type, std::void_t<typename Type::is_container_printer_sink>> : public std::true_type
+{
+};
+
+/**
+ * @brief Helper variable template.
+ */
+template <typename Type> constexpr bool is_sink_v = is_sink<Type>::value;
+
+/**
+ * @brief Base case for the detection of sinks that only count the characters written to them; see
+ * `sinks::counting_sink`.
+ */
+template <typename Type, typename = void> struct is_counting_sink : public std::false_type
+{
+};
+
+/**
+ * @brief Specialization to detect counting sinks.
+ */
+template <typename Type>
+struct is_counting_sink<Type, std::void_t<typename Type::is_container_printer_counting_sink>>
+    : public std::true_type
+{
+};
+
+/**
+ * @brief Helper variable template.
+ */
+template <typename Type> constexpr bool is_counting_sink_v = is_counting_sink<Type>::value;
+
+/**
+ * @brief Base case for the detection of containers that store their elements contiguously.
+ */
+template <typename Type, typename = void> struct is_contiguous_container : public std::false_type
+{
+};
+
+/**
+ * @brief Specialization to detect containers, such as `std::vector<...>`, `std::array<...>`, and
+ * arrays, for which `std::data(...)` and `std::size(...)` can be used.
+ */
+template <typename Type>
+struct is_contiguous_container<
+    Type, std::void_t<
+              decltype(std::data(std::declval<const Type&>())),
+              decltype(std::size(std::declval<const Type&>()))>>
+    : public std::is_pointer<decltype(std::data(std::declval<const Type&>()))>
+{
+};
+
+/**
+ * @brief Helper variable template.
+ */
+template <typename Type>
+constexpr bool is_contiguous_container_v = is_contiguous_container<Type>::value;
+} // namespace traits
+
+namespace decorator
+{
+/**
+ * @brief Struct to neatly wrap up all the additional characters we'll need in order to
+ * print out the containers. The delimiters carry their lengths, so that writing them never needs
+ * to search for a null terminator.
+ */
+template <typename CharacterType> struct wrapper
+{
+    using type = CharacterType;
+
+    std::basic_string_view<type> prefix;
+    std::basic_string_view<type> separator;
+    std::basic_string_view<type> suffix;
+};
+
+/**
+ * @brief Delimiters chosen at runtime, rather than through a `delimiters<...>` specialization.
+ *
+ * The delimiters are validated once, on construction: none may exceed `max_length` characters, so
+ * that the kernels that copy a separator along with every element can size their blocks up front.
+ */
+template <typename CharacterType> class delimiter_set
+{
+  public:
+    using type = CharacterType;
+
+    static constexpr std::size_t max_length = 64;
+
+    /**
+     * @throws std::length_error if any of the delimiters is longer than `max_length` characters.
+     */
+    constexpr delimiter_set(
+        std::basic_string_view<type> prefix, std::basic_string_view<type> separator,
+        std::basic_string_view<type> suffix)
+        : m_values{ validate(prefix), validate(separator), validate(suffix) }
+    {
+    }
+
+    constexpr const wrapper<type>& values() const noexcept
+    {
+        return m_values;
+    }
+
+  private:
+    static constexpr std::basic_string_view<type> validate(std::basic_string_view<type> delimiter)
+    {
+        if (delimiter.size() > max_length) {
+            throw std::length_error{ "A delimiter may not exceed delimiter_set::max_length." };
+        }
+
+        return delimiter;
+    }
+
+    wrapper<type> m_values;
+};
+
+template <typename CharacterType>
+delimiter_set(const CharacterType*, const CharacterType*, const CharacterType*)
+    -> delimiter_set<CharacterType>;
+
+/**
+ * @brief An ASCII string, widened to the given character type at compile time.
+ */
+template <typename CharacterType, char... Characters> struct literal
+{
+    static constexpr CharacterType characters[] = { static_cast<CharacterType>(Characters)...,
+                                                    CharacterType{} };
+
+    static constexpr std::basic_string_view<CharacterType> value{ characters,
+                                                                  sizeof...(Characters) };
+};
+
+/**
+ * @brief Helper variable template.
+ */
+template <typename CharacterType, char... Characters>
+inline constexpr std::basic_string_view<CharacterType> literal_v =
+    literal<CharacterType, Characters...>::value;
+
+/**
+ * @brief Delimiters that enclose the elements in the given pair of brackets, and that separate
+ * them with a comma and a space, for any character type.
+ */
+template <typename CharacterType, char Opening, char Closing>
+inline constexpr wrapper<CharacterType> enclosed_by = { literal_v<CharacterType, Opening>,
+                                                        literal_v<CharacterType, ',', ' '>,
+                                                        literal_v<CharacterType, Closing> };
+
+/**
+ * @brief Default delimiters for any container type that isn't even more specialized. Each of the
+ * definitions below serves every character type, since the tables are generated at compile time.
+ */
+template <typename /*ContainerType*/, typename CharacterType> struct delimiters
+{
+    using type = wrapper<CharacterType>;
+
+    static constexpr type values = enclosed_by<CharacterType, '[', ']'>;
+};
+
+/**
+ * @brief Specialization for std::set<...> instances.
+ */
+template <
+    typename DataType, typename ComparatorType, typename AllocatorType, typename CharacterType>
+struct delimiters<std::set<DataType, ComparatorType, AllocatorType>, CharacterType>
+{
+    static constexpr wrapper<CharacterType> values = enclosed_by<CharacterType, '{', '}'>;
+};
+
+/**
+ * @brief Specialization for std::multiset<...> instances.
+ */
+template <
+    typename DataType, typename ComparatorType, typename AllocatorType, typename CharacterType>
+struct delimiters<std::multiset<DataType, ComparatorType, AllocatorType>, CharacterType>
+{
+    static constexpr wrapper<CharacterType> values = enclosed_by<CharacterType, '{', '}'>;
+};
+
+/**
+ * @brief Specialization for std::pair<...> instances.
+ */
+template <typename FirstType, typename SecondType, typename CharacterType>
+struct delimiters<std::pair<FirstType, SecondType>, CharacterType>
+{
+    static constexpr wrapper<CharacterType> values = enclosed_by<CharacterType, '(', ')'>;
+};
+
+/**
+ * @brief Specialization for std::tuple<...> instances.
+ */
+template <typename CharacterType, typename... DataType>
+struct delimiters<std::tuple<DataType...>, CharacterType>
+{
+    static constexpr wrapper<CharacterType> values = enclosed_by<CharacterType, '<', '>'>;
+};
+} // namespace decorator
+
+/**
+ * @brief Controls how integral elements are converted to text.
+ */
+enum class integer_format
+{
+    /**
+     * Use the locale-free conversion unless the target stream has state (a non-decimal base,
+     * `std::showpos`, or a non-classic locale) that would change the output.
+     */
+    automatic,
+
+    /**
+     * Always use the locale-free conversion; stream flags such as `std::hex` are ignored.
+     */
+    locale_free,
+
+    /**
+     * Always insert through `operator<<`, with exact iostream semantics.
+     */
+    stream
+};
+
+/**
+ * @brief Controls how floating-point elements are converted to text.
+ */
+enum class float_format
+{
+    /**
+     * Use the locale-free conversion, with the stream's precision, unless the target stream has
+     * state (`std::fixed`, `std::scientific`, `std::showpoint`, and the like, or a non-classic
+     * locale) that would change the output. The output matches that of `operator<<`.
+     */
+    automatic,
+
+    /**
+     * Print the shortest representation that parses back to the exact same value.
+     */
+    shortest,
+
+    /**
+     * Print a fixed number of decimals, as given by `format_options::float_precision`.
+     */
+    fixed,
+
+    /**
+     * Always insert through `operator<<`, with exact iostream semantics.
+     */
+    stream
+};
+
+/**
+ * @brief Controls the parallel formatting of large containers.
+ *
+ * Contiguous containers of numbers are split into chunks that are formatted into separate buffers.
+ * Other containers are traversed element by element, during which runs of small elements are
+ * grouped into chunks and large nested containers become tasks of their own. Either way, the tasks
+ * run on a work-stealing executor, and the buffers are written to the output in order, so the
+ * output is identical to that of the serial path. The executor's threads are kept in a pool between
+ * prints, so repeated prints don't pay for starting threads.
+ *
+ * Elements that are printed through their own `operator<<` are then formatted on the worker
+ * threads as well, so that operator has to be safe to call concurrently.
+ */
+struct parallel_options
+{
+    /**
+     * @brief The number of threads, including the calling thread. A value of one disables parallel
+     * formatting, and a value of zero uses `std::thread::hardware_concurrency()`.
+     */
+    std::size_t thread_count = 1;
+
+    /**
+     * @brief The number of elements per chunk.
+     */
+    std::size_t chunk_size = 64 * 1024;
+
+    /**
+     * @brief The number of elements below which the container is formatted serially. The elements
+     * of nested containers count towards this as well.
+     */
+    std::size_t threshold = 256 * 1024;
+
+    /**
+     * @brief The number of elements at which a nested container is formatted as a task of its own,
+     * rather than as part of a chunk of its neighbours.
+     */
+    std::size_t task_size = 4096;
+};
+
+/**
+ * @brief Options that are threaded through the traversal by the `default_formatter<...>`.
+ */
+struct format_options
+{
+    integer_format integers = integer_format::automatic;
+    float_format floats = float_format::automatic;
+
+    /**
+     * @brief The number of decimals printed in the `float_format::fixed` mode.
+     */
+    int float_precision = 6;
+
+    parallel_options parallel = {};
+
+    /**
+     * @brief Formats the entire container into a thread-local buffer first, and then hands it to
+     * the stream in a single write, so that the output of threads printing to the same stream
+     * concurrently doesn't interleave.
+     */
+    bool atomic_write = false;
+};
+
+template <typename ContainerType, typename StreamType> struct default_formatter;
+
+namespace detail
+{
+/**
+ * @brief Lookup table of all two-digit decimal numbers, used to convert integers two digits at a
+ * time.
+ */
+inline constexpr char digit_pairs[] = "00010203040506070809"
+                               "10111213141516171819"
+                               "20212223242526272829"
+                               "30313233343536373839"
+                               "40414243444546474849"
+                               "50515253545556575859"
+                               "60616263646566676869"
+                               "70717273747576777879"
+                               "80818283848586878889"
+                               "90919293949596979899";
+
+/**
+ * @brief Integral types that are printed as numbers, rather than as characters or booleans.
+ */
+template <typename Type>
+constexpr bool is_numeric_integer_v =
+    std::is_integral_v<Type> && !std::is_same_v<Type, bool> && !std::is_same_v<Type, char> &&
+    !std::is_same_v<Type, signed char> && !std::is_same_v<Type, unsigned char> &&
+    !std::is_same_v<Type, wchar_t> && !std::is_same_v<Type, char16_t> &&
+    !std::is_same_v<Type, char32_t>
+#if defined(__cpp_char8_t)
+    && !std::is_same_v<Type, char8_t>
+#endif
+    ;
+
+/**
+ * @brief Upper bound on the number of characters needed to print an integer of the given type.
+ */
+template <typename IntegerType>
+constexpr std::size_t max_integer_length = std::numeric_limits<IntegerType>::digits10 + 2;
+
+/**
+ * @brief Converts an integer to decimal, writing backwards from `last`.
+ *
+ * @returns A pointer to the first character written.
+ */
+template <typename IntegerType>
+constexpr char* format_integer(char* last, IntegerType value) noexcept
+{
+    using unsigned_type = std::make_unsigned_t<IntegerType>;
+
+    const bool is_negative = value < 0;
+    auto magnitude = is_negative ? static_cast<unsigned_type>(0 - static_cast<unsigned_type>(value))
+                                 : static_cast<unsigned_type>(value);
+
+    while (magnitude >= 100) {
+        const auto index = static_cast<std::size_t>(magnitude % 100) * 2;
+        magnitude /= 100;
+
+        *--last = digit_pairs[index + 1];
+        *--last = digit_pairs[index];
+    }
+
+    if (magnitude >= 10) {
+        const auto index = static_cast<std::size_t>(magnitude) * 2;
+
+        *--last = digit_pairs[index + 1];
+        *--last = digit_pairs[index];
+    } else {
+        *--last = static_cast<char>('0' + magnitude);
+    }
+
+    if (is_negative) {
+        *--last = '-';
+    }
+
+    return last;
+}
+
+/**
+ * @returns The number of characters that `format_integer(...)` produces for the given value.
+ */
+template <typename IntegerType> constexpr std::size_t integer_length(IntegerType value) noexcept
+{
+    using unsigned_type = std::make_unsigned_t<IntegerType>;
+
+    const bool is_negative = value < 0;
+    auto magnitude = is_negative ? static_cast<unsigned_type>(0 - static_cast<unsigned_type>(value))
+                                 : static_cast<unsigned_type>(value);
+
+    std::size_t length = is_negative ? 2 : 1;
+    while (magnitude >= 10'000) {
+        magnitude /= 10'000;
+        length += 4;
+    }
+
+    return length + (magnitude >= 10) + (magnitude >= 100) + (magnitude >= 1'000);
+}
+
+/**
+ * @brief Converts a floating-point value to text in the given `std::chars_format`. If no precision
+ * is given, the format is ignored and the shortest round-trip representation is produced instead.
+ *
+ * @returns A pointer one past the last character written, or `nullptr` if the buffer is too small.
+ */
+template <typename FloatType>
+char* format_float(
+    char* first, char* last, FloatType value, std::chars_format format, int precision = -1) noexcept
+{
+#if defined(__cpp_lib_to_chars)
+    const auto result = precision < 0 ? std::to_chars(first, last, value)
+                                      : std::to_chars(first, last, value, format, precision);
+
+    return result.ec == std::errc{} ? result.ptr : nullptr;
+#else
+    // Without floating-point support in `std::to_chars`, fall back on `std::snprintf` and, for the
+    // shortest representation, search for the lowest precision that survives a round trip.
+    const auto size = static_cast<std::size_t>(last - first);
+    const auto print = [&](const char* specifier, int digits) noexcept {
+        const auto length =
+            std::snprintf(first, size, specifier, digits, static_cast<long double>(value));
+
+        return length >= 0 && static_cast<std::size_t>(length) < size ? first + length : nullptr;
+    };
+
+    if (format == std::chars_format::fixed) {
+        return print("%.*Lf", precision);
+    }
+
+    if (precision >= 0) {
+        return print("%.*Lg", precision);
+    }
+
+    for (int digits = std::numeric_limits<FloatType>::digits10;
+         digits < std::numeric_limits<FloatType>::max_digits10; ++digits) {
+        auto* const end = print("%.*Lg", digits);
+        if (end != nullptr && static_cast<FloatType>(std::strtold(first, nullptr)) == value) {
+            return end;
+        }
+    }
+
+    return print("%.*Lg", std::numeric_limits<FloatType>::max_digits10);
+#endif
+}
+
+/**
+ * @brief Writes a run of ASCII characters to a sink of any character type.
+ */
+template <typename SinkType> void write_ascii(SinkType& sink, const char* data, std::size_t size)
+{
+    using char_type = typename SinkType::char_type;
+
+    if constexpr (std::is_same_v<char_type, char>) {
+        sink.write(data, size);
+    } else {
+        constexpr std::size_t block_size = 64;
+        char_type block[block_size];
+
+        while (size != 0) {
+            const auto count = size < block_size ? size : block_size;
+            for (std::size_t index = 0; index < count; ++index) {
+                block[index] = static_cast<char_type>(data[index]);
+            }
+
+            sink.write(block, count);
+
+            data += count;
+            size -= count;
+        }
+    }
+}
+
+/**
+ * @brief Narrow strings that are printed to a stream or sink of another character type, and that
+ * are therefore decoded from UTF-8 by `write_utf8(...)`, rather than widened one character at a
+ * time.
+ */
+template <typename Type, typename CharacterType>
+constexpr bool is_narrow_text_v =
+    !std::is_same_v<CharacterType, char> && std::is_convertible_v<const Type&, std::string_view>;
+
+/**
+ * @returns True if narrow text is decoded from UTF-8 under the given locale, which is the case for
+ * the classic locale, and for locales whose character encoding is UTF-8. Under any other locale,
+ * narrow characters are widened by the locale's `ctype<...>` facet instead, as `operator<<` does.
+ */
+template <typename LocaleType> bool has_utf8_encoding(const LocaleType& locale)
+{
+    auto name = locale.name();
+
+    // Locales that differ by category are named after each category in turn.
+    const auto category = name.find("LC_CTYPE=");
+    if (category != std::string::npos) {
+        name = name.substr(category + 9, name.find(';', category) - category - 9);
+    }
+
+    if (name == "C" || name == "POSIX") {
+        return true;
+    }
+
+    std::transform(std::begin(name), std::end(name), std::begin(name), [](char character) {
+        return character >= 'A' && character <= 'Z' ? static_cast<char>(character - 'A' + 'a')
+                                                    : character;
+    });
+
+    return name.find("utf-8") != std::string::npos || name.find("utf8") != std::string::npos;
+}
+
+/**
+ * @returns True if narrow text is decoded from UTF-8 when written to a stream of the given
+ * character type under the given locale. Narrow streams never decode narrow text, so their locale
+ * isn't consulted at all.
+ */
+template <typename CharacterType, typename LocaleType>
+bool has_utf8_text(const LocaleType& locale)
+{
+    if constexpr (std::is_same_v<CharacterType, char>) {
+        return true;
+    } else {
+        return has_utf8_encoding(locale);
+    }
+}
+
+/**
+ * @brief Remembers, for the duration of a print to a wide stream that isn't a sink, whether narrow
+ * text is decoded from UTF-8 under the stream's locale, so that the locale is consulted at most
+ * once per print, rather than once per element. A print to another stream, nested within the first,
+ * takes over until it returns. Sinks and narrow streams need no such scope, and for them it does
+ * nothing.
+ */
+template <typename StreamType> class narrow_text_scope
+{
+  public:
+    explicit narrow_text_scope([[maybe_unused]] const StreamType& stream) noexcept
+    {
+        if constexpr (is_needed) {
+            m_is_owner = current().stream != &stream;
+
+            if (m_is_owner) {
+                m_previous = current();
+                current() = { &stream, false, false };
+            }
+        }
+    }
+
+    ~narrow_text_scope() noexcept
+    {
+        if constexpr (is_needed) {
+            if (m_is_owner) {
+                current() = m_previous;
+            }
+        }
+    }
+
+    narrow_text_scope(const narrow_text_scope&) = delete;
+    narrow_text_scope& operator=(const narrow_text_scope&) = delete;
+
+    /**
+     * @returns True if narrow text is decoded from UTF-8 when written to the given stream. The
+     * locale is consulted the first time that this is asked within a scope for the stream, and
+     * every time outside of one.
+     */
+    static bool has_utf8_text(const StreamType& stream)
+    {
+        auto& state = current();
+        if (state.stream != &stream) {
+            return has_utf8_encoding(stream.getloc());
+        }
+
+        if (!state.is_known) {
+            state.has_utf8_text = has_utf8_encoding(stream.getloc());
+            state.is_known = true;
+        }
+
+        return state.has_utf8_text;
+    }
+
+  private:
+    static constexpr bool is_needed =
+        !traits::is_sink_v<StreamType> && !std::is_same_v<typename StreamType::char_type, char>;
+
+    struct state
+    {
+        const void* stream = nullptr;
+        bool is_known = false;
+        bool has_utf8_text = false;
+    };
+
+    static state& current() noexcept
+    {
+        thread_local state value;
+        return value;
+    }
+
+    bool m_is_owner = false;
+    state m_previous;
+};
+
+/**
+ * @brief Decodes UTF-8 text and writes it to a stream or sink of another character type.
+ */
+template <typename StreamType> void write_utf8(StreamType& stream, std::string_view text);
+
+/**
+ * @brief Writes an integer to a sink without going through any locale machinery.
+ */
+template <typename SinkType, typename IntegerType>
+void write_integer(SinkType& sink, IntegerType value)
+{
+    if constexpr (traits::is_counting_sink_v<SinkType>) {
+        sink.skip(integer_length(value));
+        return;
+    }
+
+    char buffer[max_integer_length<IntegerType>];
+
+    auto* const last = buffer + sizeof(buffer);
+    const auto* const first = format_integer(last, value);
+
+    write_ascii(sink, first, static_cast<std::size_t>(last - first));
+}
+
+/**
+ * @brief The `std::to_chars(...)` arguments that a `float_format` resolves to.
+ */
+struct float_spec
+{
+    std::chars_format format;
+    int precision;
+};
+
+/**
+ * @brief Resolves a `float_format` to the arguments for `format_float(...)`. The automatic and
+ * stream modes both resolve to the general format that `operator<<` uses by default.
+ */
+constexpr float_spec make_float_spec(float_format format, int precision) noexcept
+{
+    switch (format) {
+        case float_format::shortest:
+            return { std::chars_format::general, -1 };
+        case float_format::fixed:
+            return { std::chars_format::fixed, precision };
+        case float_format::automatic:
+        case float_format::stream:
+            break;
+    }
+
+    return { std::chars_format::general, precision };
+}
+
+/**
+ * @brief Writes a floating-point value to a sink without going through any locale machinery.
+ */
+template <typename SinkType, typename FloatType>
+void write_float(SinkType& sink, FloatType value, const float_spec& spec)
+{
+    const auto [chars_format, precision] = spec;
+
+    char buffer[128];
+    auto* const last =
+        format_float(buffer, buffer + sizeof(buffer), value, chars_format, precision);
+
+    if (last != nullptr) {
+        write_ascii(sink, buffer, static_cast<std::size_t>(last - buffer));
+        return;
+    }
+
+    // Only very large values printed in the fixed format fail to fit in the buffer above.
+    std::string large_buffer(
+        static_cast<std::size_t>(std::numeric_limits<FloatType>::max_exponent10 + precision) + 8,
+        '\0');
+
+    auto* const first = large_buffer.data();
+    auto* const end =
+        format_float(first, first + large_buffer.size(), value, chars_format, precision);
+
+    write_ascii(sink, first, static_cast<std::size_t>(end - first));
+}
+
+/**
+ * @brief Formats values that have no native representation through their own `operator<<`.
+ *
+ * Only declared here, so that this header doesn't depend on the iostreams library. The definition
+ * comes with `container_printer.h`, which has to be included in order to print such values.
+ */
+template <typename CharacterType> struct stream_formatter;
+} // namespace detail
+
+namespace sinks
+{
+/**
+ * @brief CRTP base for all output sinks.
+ *
+ * A sink is the low-level target that the traversal writes into. Derived types need only provide
+ * `write(const char_type*, std::size_t)` and `insert_formatted(const Type&)`; the latter handles
+ * elements that have no native representation and have to be formatted through `operator<<`.
+ *
+ * Sinks also provide an `operator<<` of their own, so that custom formatters written against
+ * `std::basic_ostream<...>` can be used with a sink without any changes.
+ */
+template <typename DerivedType, typename CharacterType> class sink_base
+{
+  public:
+    using char_type = CharacterType;
+    using traits_type = std::char_traits<CharacterType>;
+    using is_container_printer_sink = void;
+
+    void put(char_type character)
+    {
+        derived().write(&character, 1);
+    }
+
+    void write(const char_type* string)
+    {
+        derived().write(string, traits_type::length(string));
+    }
+
+    /**
+     * @returns True if integers can be written with the locale-free conversion without changing
+     * the output; sinks that aren't backed by a stream have no state that could interfere.
+     */
+    bool has_plain_integers() const noexcept
+    {
+        return true;
+    }
+
+    /**
+     * @returns True if floating-point values can be written with the locale-free conversion, at
+     * the precision reported by `float_precision()`, without changing the output.
+     */
+    bool has_plain_floats() const noexcept
+    {
+        return true;
+    }
+
+    /**
+     * @returns True if narrow strings are decoded from UTF-8, rather than widened one character at
+     * a time through a locale; sinks that aren't backed by a stream have no locale.
+     */
+    bool has_utf8_text() const noexcept
+    {
+        return true;
+    }
+
+    /**
+     * @returns The precision that a default-constructed stream would have used.
+     */
+    int float_precision() const noexcept
+    {
+        return 6;
+    }
+
+    template <typename Type> void insert(const Type& value)
+    {
+        if constexpr (traits::is_printable_as_container_v<Type>) {
+            to_stream(derived(), value, default_formatter<Type, DerivedType>{});
+        } else if constexpr (detail::is_numeric_integer_v<Type>) {
+            if (derived().has_plain_integers()) {
+                detail::write_integer(derived(), value);
+            } else {
+                derived().insert_formatted(value);
+            }
+        } else if constexpr (std::is_floating_point_v<Type>) {
+            if (derived().has_plain_floats()) {
+                detail::write_float(
+                    derived(), value,
+                    detail::make_float_spec(float_format::automatic, derived().float_precision()));
+            } else {
+                derived().insert_formatted(value);
+            }
+        } else if constexpr (std::is_same_v<Type, char_type>) {
+            derived().put(value);
+        } else if constexpr (
+            std::is_same_v<Type, const char_type*> || std::is_same_v<Type, char_type*>) {
+            write(value);
+        } else if constexpr (std::is_convertible_v<
+                                 const Type&, std::basic_string_view<char_type>>) {
+            const std::basic_string_view<char_type> view = value;
+            derived().write(view.data(), view.size());
+        } else if constexpr (detail::is_narrow_text_v<Type, char_type>) {
+            // Only wide streams have a locale that could widen the characters any differently.
+            if constexpr (std::is_same_v<char_type, wchar_t>) {
+                if (!derived().has_utf8_text()) {
+                    for (const auto character : std::string_view{ value }) {
+                        derived().insert_formatted(character);
+                    }
+
+                    return;
+                }
+            }
+
+            detail::write_utf8(derived(), value);
+        } else if constexpr (std::is_same_v<Type, char> && !std::is_same_v<char_type, wchar_t>) {
+            // There is no stream to widen a lone narrow character to any other character type, so
+            // it is treated as UTF-8 text of its own.
+            detail::write_utf8(derived(), std::string_view{ &value, 1 });
+        } else {
+            derived().insert_formatted(value);
+        }
+    }
+
+    template <typename Type> friend DerivedType& operator<<(DerivedType& sink, const Type& value)
+    {
+        sink.insert(value);
+        return sink;
+    }
+
+    /**
+     * @brief Fallback for elements without a native representation; formats the element as a
+     * default-constructed stream would have, and writes the result to the sink.
+     *
+     * Arithmetic values are converted here, so that printing them never needs the iostreams
+     * library; anything else is formatted through its own `operator<<`.
+     */
+    template <typename Type> void insert_formatted(const Type& value)
+    {
+        if constexpr (std::is_same_v<Type, bool>) {
+            derived().put(value ? char_type('1') : char_type('0'));
+        } else if constexpr (detail::is_numeric_integer_v<Type>) {
+            detail::write_integer(derived(), value);
+        } else if constexpr (std::is_floating_point_v<Type>) {
+            detail::write_float(
+                derived(), value, detail::make_float_spec(float_format::automatic, 6));
+        } else {
+            detail::stream_formatter<char_type>::write(derived(), value);
+        }
+    }
+
+  private:
+    DerivedType& derived() noexcept
+    {
+        return static_cast<DerivedType&>(*this);
+    }
+};
+
+/**
+ * @brief Sink that appends to a `std::basic_string<...>`.
+ */
+template <
+    typename CharacterType, typename CharacterTraitsType = std::char_traits<CharacterType>,
+    typename AllocatorType = std::allocator<CharacterType>>
+class string_sink : public sink_base<
+                        string_sink<CharacterType, CharacterTraitsType, AllocatorType>,
+                        CharacterType>
+{
+  public:
+    using string_type = std::basic_string<CharacterType, CharacterTraitsType, AllocatorType>;
+
+    explicit string_sink(string_type& string) noexcept : m_string{ string }
+    {
+    }
+
+    using sink_base<string_sink, CharacterType>::write;
+
+    void put(CharacterType character)
+    {
+        m_string.push_back(character);
+    }
+
+    void write(const CharacterType* data, std::size_t size)
+    {
+        m_string.append(data, size);
+    }
+
+    /**
+     * @brief Makes room for `size` characters at the end of the string, which the caller may then
+     * write to directly. The string must be trimmed with `commit_direct(...)` afterwards.
+     */
+    CharacterType* reserve_direct(std::size_t size)
+    {
+        const auto old_size = m_string.size();
+        m_string.resize(old_size + size);
+
+        return m_string.data() + old_size;
+    }
+
+    /**
+     * @brief Trims the string after a direct write, given one past the last character written.
+     */
+    void commit_direct(const CharacterType* end) noexcept
+    {
+        m_string.resize(static_cast<std::size_t>(end - m_string.data()));
+    }
+
+  private:
+    string_type& m_string;
+};
+
+/**
+ * @brief Sink that writes into a caller-provided, contiguous character buffer.
+ *
+ * Output that does not fit is dropped, but still counted, so that `size()` always reports the
+ * number of characters that the complete output would have required.
+ */
+template <typename CharacterType>
+class buffer_sink : public sink_base<buffer_sink<CharacterType>, CharacterType>
+{
+  public:
+    buffer_sink(CharacterType* buffer, std::size_t capacity) noexcept
+        : m_buffer{ buffer }, m_capacity{ capacity }
+    {
+    }
+
+    using sink_base<buffer_sink, CharacterType>::write;
+
+    void put(CharacterType character) noexcept
+    {
+        if (m_size < m_capacity) {
+            m_buffer[m_size] = character;
+        }
+
+        ++m_size;
+    }
+
+    void write(const CharacterType* data, std::size_t size) noexcept
+    {
+        if (m_size < m_capacity) {
+            const auto available = m_capacity - m_size;
+            std::char_traits<CharacterType>::copy(
+                m_buffer + m_size, data, size < available ? size : available);
+        }
+
+        m_size += size;
+    }
+
+    /**
+     * @returns The number of characters that the output requires, including any that didn't fit.
+     */
+    std::size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+    /**
+     * @returns The number of characters that were actually written into the buffer.
+     */
+    std::size_t written() const noexcept
+    {
+        return m_size < m_capacity ? m_size : m_capacity;
+    }
+
+    bool truncated() const noexcept
+    {
+        return m_size > m_capacity;
+    }
+
+  private:
+    CharacterType* m_buffer;
+    std::size_t m_capacity;
+    std::size_t m_size = 0;
+};
+
+/**
+ * @brief Sink that discards its output, and only counts the number of characters that would have
+ * been written. Integers are measured without generating any of their digits.
+ */
+template <typename CharacterType>
+class counting_sink : public sink_base<counting_sink<CharacterType>, CharacterType>
+{
+  public:
+    using is_container_printer_counting_sink = void;
+
+    using sink_base<counting_sink, CharacterType>::write;
+
+    void put(CharacterType /*character*/) noexcept
+    {
+        ++m_size;
+    }
+
+    void write(const CharacterType* /*data*/, std::size_t size) noexcept
+    {
+        m_size += size;
+    }
+
+    /**
+     * @brief Counts the given number of characters, without them having been produced.
+     */
+    void skip(std::size_t size) noexcept
+    {
+        m_size += size;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+  private:
+    std::size_t m_size = 0;
+};
+
+/**
+ * @brief Sink that writes through an output iterator.
+ */
+template <typename OutputIteratorType, typename CharacterType>
+class iterator_sink
+    : public sink_base<iterator_sink<OutputIteratorType, CharacterType>, CharacterType>
+{
+  public:
+    explicit iterator_sink(OutputIteratorType iterator) : m_iterator{ std::move(iterator) }
+    {
+    }
+
+    using sink_base<iterator_sink, CharacterType>::write;
+
+    void put(CharacterType character)
+    {
+        *m_iterator = character;
+        ++m_iterator;
+    }
+
+    void write(const CharacterType* data, std::size_t size)
+    {
+        m_iterator = std::copy(data, data + size, m_iterator);
+    }
+
+    /**
+     * @returns The iterator one past the last character written.
+     */
+    OutputIteratorType out() const
+    {
+        return m_iterator;
+    }
+
+  private:
+    OutputIteratorType m_iterator;
+};
+
+/**
+ * @brief Helper function to deduce the iterator type of an `iterator_sink<...>`.
+ */
+template <typename CharacterType, typename OutputIteratorType>
+iterator_sink<OutputIteratorType, CharacterType> make_iterator_sink(OutputIteratorType iterator)
+{
+    return iterator_sink<OutputIteratorType, CharacterType>{ std::move(iterator) };
+}
+
+} // namespace sinks
+
+namespace detail
+{
+/**
+ * @brief Writes a delimiter to either a sink or a stream.
+ */
+template <typename StreamType>
+void write_literal(
+    StreamType& stream, std::basic_string_view<typename StreamType::char_type> literal)
+{
+    if constexpr (traits::is_sink_v<StreamType>) {
+        stream.write(literal.data(), literal.size());
+    } else {
+        stream << literal;
+    }
+}
+
+/**
+ * @brief Writes a single non-container element to either a sink or a stream.
+ */
+template <typename StreamType, typename ElementType>
+void write_element(StreamType& stream, const ElementType& element, const format_options& options)
+{
+    if constexpr (traits::is_sink_v<StreamType>) {
+        if constexpr (is_numeric_integer_v<ElementType>) {
+            switch (options.integers) {
+                case integer_format::locale_free:
+                    write_integer(stream, element);
+                    return;
+                case integer_format::stream:
+                    stream.insert_formatted(element);
+                    return;
+                case integer_format::automatic:
+                    break;
+            }
+        } else if constexpr (std::is_floating_point_v<ElementType>) {
+            switch (options.floats) {
+                case float_format::shortest:
+                case float_format::fixed:
+                    write_float(
+                        stream, element, make_float_spec(options.floats, options.float_precision));
+                    return;
+                case float_format::stream:
+                    stream.insert_formatted(element);
+                    return;
+                case float_format::automatic:
+                    break;
+            }
+        }
+
+        stream.insert(element);
+    } else if constexpr (is_narrow_text_v<ElementType, typename StreamType::char_type>) {
+        if (narrow_text_scope<StreamType>::has_utf8_text(stream)) {
+            write_utf8(stream, element);
+        } else {
+            for (const auto character : std::string_view{ element }) {
+                stream << character;
+            }
+        }
+    } else {
+        stream << element;
+    }
+}
+
+/**
+ * @returns True if elements of the given type can be written to the sink with the locale-free
+ * conversions, given the options and the sink's state.
+ */
+template <typename ElementType, typename SinkType>
+bool has_plain_elements(const SinkType& sink, const format_options& options) noexcept
+{
+    if constexpr (is_numeric_integer_v<ElementType>) {
+        return options.integers == integer_format::locale_free ||
+               (options.integers == integer_format::automatic && sink.has_plain_integers());
+    } else if constexpr (std::is_floating_point_v<ElementType>) {
+        return options.floats == float_format::shortest || options.floats == float_format::fixed ||
+               (options.floats == float_format::automatic && sink.has_plain_floats());
+    } else {
+        return false;
+    }
+}
+
+/**
+ * @brief The element type of a contiguous container.
+ */
+template <typename ContainerType> struct contiguous_element
+{
+    using type = std::remove_cv_t<
+        std::remove_reference_t<decltype(*std::data(std::declval<const ContainerType&>()))>>;
+};
+
+/**
+ * @brief Base case for containers that can't be handed to `write_contiguous(...)`.
+ */
+template <typename ContainerType, typename StreamType, typename FormatterType, typename = void>
+constexpr bool is_bulk_formattable_v = false;
+
+/**
+ * @brief Contiguous containers of numbers, printed to a sink by the `default_formatter<...>`, can
+ * be handed to `write_contiguous(...)`.
+ */
+template <typename ContainerType, typename StreamType, typename FormatterType>
+constexpr bool is_bulk_formattable_v<
+    ContainerType, StreamType, FormatterType,
+    std::enable_if_t<
+        traits::is_sink_v<StreamType> && traits::is_contiguous_container_v<ContainerType> &&
+        std::is_same_v<FormatterType, default_formatter<ContainerType, StreamType>>>> =
+    is_numeric_integer_v<typename contiguous_element<ContainerType>::type> ||
+    std::is_floating_point_v<typename contiguous_element<ContainerType>::type>;
+
+/**
+ * @brief Collects output in a thread-local scratch block and hands the block to the sink whenever
+ * it fills up.
+ */
+template <typename SinkType> class block_writer
+{
+  public:
+    using char_type = typename SinkType::char_type;
+
+    static constexpr std::size_t capacity = 8192;
+
+    explicit block_writer(SinkType& sink) noexcept : m_sink{ sink }, m_block{ scratch() }
+    {
+    }
+
+    block_writer(const block_writer&) = delete;
+    block_writer& operator=(const block_writer&) = delete;
+
+    /**
+     * @brief Ensures that at least `size` characters, which may not exceed the capacity, can be
+     * appended without overflowing the block. Longer runs of characters go through `write(...)`.
+     */
+    void reserve(std::size_t size)
+    {
+        if (size > capacity - m_used) {
+            flush();
+        }
+    }
+
+    void append(const char_type* data, std::size_t size) noexcept
+    {
+        std::char_traits<char_type>::copy(m_block + m_used, data, size);
+        m_used += size;
+    }
+
+    /**
+     * @brief Appends characters that needn't have been reserved, and that may exceed the capacity;
+     * those that don't fit in the block are handed to the sink directly, after the block itself.
+     */
+    void write(const char_type* data, std::size_t size)
+    {
+        reserve(std::min(size, capacity));
+
+        if (size > capacity) {
+            m_sink.write(data, size);
+        } else {
+            append(data, size);
+        }
+    }
+
+    void append_ascii(const char* data, std::size_t size) noexcept
+    {
+        if constexpr (std::is_same_v<char_type, char>) {
+            std::memcpy(m_block + m_used, data, size);
+        } else {
+            for (std::size_t index = 0; index < size; ++index) {
+                m_block[m_used + index] = static_cast<char_type>(data[index]);
+            }
+        }
+
+        m_used += size;
+    }
+
+    /**
+     * @returns The position at which the next character will be appended. Callers that write
+     * through this pointer must have reserved enough room, and must then call `advance(...)`.
+     */
+    char_type* position() noexcept
+    {
+        return m_block + m_used;
+    }
+
+    void advance(std::size_t size) noexcept
+    {
+        m_used += size;
+    }
+
+    void flush()
+    {
+        m_sink.write(m_block, m_used);
+        m_used = 0;
+    }
+
+  private:
+    static char_type* scratch() noexcept
+    {
+        thread_local char_type block[capacity];
+        return block;
+    }
+
+    SinkType& m_sink;
+    char_type* m_block;
+    std::size_t m_used = 0;
+};
+
+namespace simd
+{
+/**
+ * @brief The instruction sets for which a batch conversion kernel exists.
+ */
+enum class instruction_set
+{
+    scalar,
+    sse41,
+    avx2
+};
+
+inline instruction_set detect_instruction_set() noexcept
+{
+#if defined(CONTAINER_PRINTER_HAS_X86_SIMD) && defined(_MSC_VER) && !defined(__clang__)
+    int registers[4];
+
+    __cpuid(registers, 0);
+    const auto highest_leaf = registers[0];
+
+    __cpuid(registers, 1);
+    const bool has_sse41 = (registers[2] & (1 << 19)) != 0;
+    const bool has_os_avx = (registers[2] & (1 << 27)) != 0 && (registers[2] & (1 << 28)) != 0 &&
+                            (_xgetbv(0) & 0x6) == 0x6;
+
+    if (highest_leaf >= 7 && has_os_avx) {
+        __cpuidex(registers, 7, 0);
+        if ((registers[1] & (1 << 5)) != 0) {
+            return instruction_set::avx2;
+        }
+    }
+
+    return has_sse41 ? instruction_set::sse41 : instruction_set::scalar;
+#elif defined(CONTAINER_PRINTER_HAS_X86_SIMD)
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2")) {
+        return instruction_set::avx2;
+    }
+
+    if (__builtin_cpu_supports("sse4.1")) {
+        return instruction_set::sse41;
+    }
+
+    return instruction_set::scalar;
+#else
+    return instruction_set::scalar;
+#endif
+}
+
+/**
+ * @returns The best instruction set supported by the processor, detected once per process.
+ */
+inline instruction_set active_instruction_set() noexcept
+{
+    static const auto detected = detect_instruction_set();
+    return detected;
+}
+
+/**
+ * @brief The number of integers converted per batch.
+ */
+inline constexpr std::size_t batch_size = 8;
+
+/**
+ * @brief The zero-padded decimal digits of a batch of 32-bit magnitudes.
+ *
+ * The ten digits of each magnitude are split into the two digits above 10^8 (`top`) and two runs
+ * of four, stored as ASCII in memory order, so that they can be copied straight into the output.
+ */
+struct digit_batch
+{
+    alignas(32) std::uint32_t top[batch_size];
+    alignas(32) std::uint32_t high[batch_size];
+    alignas(32) std::uint32_t low[batch_size];
+    alignas(32) std::uint32_t lengths[batch_size];
+};
+
+/**
+ * @brief Powers of ten against which magnitudes are compared to count their digits.
+ */
+inline constexpr std::uint32_t digit_thresholds[] = { 10u,        100u,        1000u,
+                                                      10000u,     100000u,     1000000u,
+                                                      10000000u,  100000000u,  1000000000u };
+
+#if defined(CONTAINER_PRINTER_HAS_X86_SIMD)
+/**
+ * @brief Divides each 32-bit lane by a constant, given as a multiplier and a right shift.
+ */
+CONTAINER_PRINTER_TARGET("sse4.1")
+inline __m128i divide_sse41(__m128i value, std::uint32_t multiplier, int shift) noexcept
+{
+    const auto factor = _mm_set1_epi32(static_cast<int>(multiplier));
+    const auto count = _mm_cvtsi32_si128(shift);
+
+    const auto even = _mm_srl_epi64(_mm_mul_epu32(value, factor), count);
+    const auto odd = _mm_srl_epi64(_mm_mul_epu32(_mm_srli_epi64(value, 32), factor), count);
+
+    return _mm_or_si128(even, _mm_slli_epi64(odd, 32));
+}
+
+/**
+ * @brief Converts each lane, which must be less than 100, into two ASCII digits.
+ */
+CONTAINER_PRINTER_TARGET("sse4.1") inline __m128i two_digits_sse41(__m128i value) noexcept
+{
+    const auto tens = _mm_srli_epi32(_mm_mullo_epi32(value, _mm_set1_epi32(103)), 10);
+    const auto ones = _mm_sub_epi32(value, _mm_mullo_epi32(tens, _mm_set1_epi32(10)));
+
+    return _mm_add_epi32(_mm_or_si128(tens, _mm_slli_epi32(ones, 8)), _mm_set1_epi32(0x3030));
+}
+
+/**
+ * @brief Converts each lane, which must be less than 10,000, into four ASCII digits.
+ */
+CONTAINER_PRINTER_TARGET("sse4.1") inline __m128i four_digits_sse41(__m128i value) noexcept
+{
+    const auto hundreds = _mm_srli_epi32(_mm_mullo_epi32(value, _mm_set1_epi32(5243)), 19);
+    const auto remainder = _mm_sub_epi32(value, _mm_mullo_epi32(hundreds, _mm_set1_epi32(100)));
+
+    return _mm_or_si128(
+        two_digits_sse41(hundreds), _mm_slli_epi32(two_digits_sse41(remainder), 16));
+}
+
+/**
+ * @brief Converts four magnitudes, starting at `offset`, with SSE4.1.
+ */
+CONTAINER_PRINTER_TARGET("sse4.1")
+inline void
+convert_sse41(const std::uint32_t* values, digit_batch& batch, std::size_t offset) noexcept
+{
+    const auto value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + offset));
+
+    auto length = _mm_set1_epi32(1);
+    for (const auto threshold : digit_thresholds) {
+        const auto power = _mm_set1_epi32(static_cast<int>(threshold));
+        length = _mm_sub_epi32(length, _mm_cmpeq_epi32(_mm_max_epu32(value, power), value));
+    }
+
+    const auto top = divide_sse41(value, 1441151881u, 57);
+    const auto rest = _mm_sub_epi32(value, _mm_mullo_epi32(top, _mm_set1_epi32(100000000)));
+    const auto high = divide_sse41(rest, 3518437209u, 45);
+    const auto low = _mm_sub_epi32(rest, _mm_mullo_epi32(high, _mm_set1_epi32(10000)));
+
+    _mm_store_si128(reinterpret_cast<__m128i*>(batch.top + offset), two_digits_sse41(top));
+    _mm_store_si128(reinterpret_cast<__m128i*>(batch.high + offset), four_digits_sse41(high));
+    _mm_store_si128(reinterpret_cast<__m128i*>(batch.low + offset), four_digits_sse41(low));
+    _mm_store_si128(reinterpret_cast<__m128i*>(batch.lengths + offset), length);
+}
+
+/**
+ * @brief Divides each 32-bit lane by a constant, given as a multiplier and a right shift.
+ */
+CONTAINER_PRINTER_TARGET("avx2")
+inline __m256i divide_avx2(__m256i value, std::uint32_t multiplier, int shift) noexcept
+{
+    const auto factor = _mm256_set1_epi32(static_cast<int>(multiplier));
+    const auto count = _mm_cvtsi32_si128(shift);
+
+    const auto even = _mm256_srl_epi64(_mm256_mul_epu32(value, factor), count);
+    const auto odd =
+        _mm256_srl_epi64(_mm256_mul_epu32(_mm256_srli_epi64(value, 32), factor), count);
+
+    return _mm256_or_si256(even, _mm256_slli_epi64(odd, 32));
+}
+
+/**
+ * @brief Converts each lane, which must be less than 100, into two ASCII digits.
+ */
+CONTAINER_PRINTER_TARGET("avx2") inline __m256i two_digits_avx2(__m256i value) noexcept
+{
+    const auto tens = _mm256_srli_epi32(_mm256_mullo_epi32(value, _mm256_set1_epi32(103)), 10);
+    const auto ones = _mm256_sub_epi32(value, _mm256_mullo_epi32(tens, _mm256_set1_epi32(10)));
+
+    return _mm256_add_epi32(
+        _mm256_or_si256(tens, _mm256_slli_epi32(ones, 8)), _mm256_set1_epi32(0x3030));
+}
+
+/**
+ * @brief Converts each lane, which must be less than 10,000, into four ASCII digits.
+ */
+CONTAINER_PRINTER_TARGET("avx2") inline __m256i four_digits_avx2(__m256i value) noexcept
+{
+    const auto hundreds = _mm256_srli_epi32(_mm256_mullo_epi32(value, _mm256_set1_epi32(5243)), 19);
+    const auto remainder =
+        _mm256_sub_epi32(value, _mm256_mullo_epi32(hundreds, _mm256_set1_epi32(100)));
+
+    return _mm256_or_si256(
+        two_digits_avx2(hundreds), _mm256_slli_epi32(two_digits_avx2(remainder), 16));
+}
+
+/**
+ * @brief Converts all eight magnitudes with AVX2.
+ */
+CONTAINER_PRINTER_TARGET("avx2")
+inline void convert_avx2(const std::uint32_t* values, digit_batch& batch) noexcept
+{
+    const auto value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values));
+
+    auto length = _mm256_set1_epi32(1);
+    for (const auto threshold : digit_thresholds) {
+        const auto power = _mm256_set1_epi32(static_cast<int>(threshold));
+        length =
+            _mm256_sub_epi32(length, _mm256_cmpeq_epi32(_mm256_max_epu32(value, power), value));
+    }
+
+    const auto top = divide_avx2(value, 1441151881u, 57);
+    const auto rest =
+        _mm256_sub_epi32(value, _mm256_mullo_epi32(top, _mm256_set1_epi32(100000000)));
+    const auto high = divide_avx2(rest, 3518437209u, 45);
+    const auto low = _mm256_sub_epi32(rest, _mm256_mullo_epi32(high, _mm256_set1_epi32(10000)));
+
+    _mm256_store_si256(reinterpret_cast<__m256i*>(batch.top), two_digits_avx2(top));
+    _mm256_store_si256(reinterpret_cast<__m256i*>(batch.high), four_digits_avx2(high));
+    _mm256_store_si256(reinterpret_cast<__m256i*>(batch.low), four_digits_avx2(low));
+    _mm256_store_si256(reinterpret_cast<__m256i*>(batch.lengths), length);
+}
+#endif
+
+/**
+ * @brief Converts a full batch of magnitudes with the given instruction set, which must not be
+ * `instruction_set::scalar`.
+ */
+inline void convert(const std::uint32_t* values, digit_batch& batch, instruction_set set) noexcept
+{
+#if defined(CONTAINER_PRINTER_HAS_X86_SIMD)
+    if (set == instruction_set::avx2) {
+        convert_avx2(values, batch);
+    } else {
+        convert_sse41(values, batch, 0);
+        convert_sse41(values, batch, 4);
+    }
+#else
+    (void)values;
+    (void)batch;
+    (void)set;
+#endif
+}
+
+/**
+ * @brief The largest number of digits in a 32-bit magnitude.
+ */
+inline constexpr std::size_t max_digits = 10;
+
+/**
+ * @brief Writes the digits of one magnitude in the batch, without leading zeros.
+ *
+ * The last eight digits are written with a single eight-byte store, shifted so that the leading
+ * zeros drop off. This means that up to eight bytes past the returned length may be overwritten.
+ *
+ * @returns The number of digits.
+ */
+inline std::size_t emit(char* output, const digit_batch& batch, std::size_t lane) noexcept
+{
+    const std::size_t length = batch.lengths[lane];
+
+    auto word = static_cast<std::uint64_t>(batch.high[lane]) |
+                (static_cast<std::uint64_t>(batch.low[lane]) << 32);
+
+    if (length <= 8) {
+        // Multi-byte stores assume a little-endian layout, which holds for every processor that
+        // the batch kernels can run on.
+        word >>= 8 * (8 - length);
+        std::memcpy(output, &word, sizeof(word));
+
+        return length;
+    }
+
+    const auto top_length = length - 8;
+    std::memcpy(output, reinterpret_cast<const char*>(&batch.top[lane]) + 2 - top_length, 2);
+    std::memcpy(output + top_length, &word, sizeof(word));
+
+    return length;
+}
+
+/**
+ * @brief Integer types that the batch kernel accepts; 64-bit batches are only converted in bulk if
+ * every magnitude in the batch fits in 32 bits.
+ */
+template <typename Type>
+constexpr bool is_batchable_v = is_numeric_integer_v<Type> && sizeof(Type) <= 8;
+
+#if defined(CONTAINER_PRINTER_HAS_X86_SIMD)
+/**
+ * @brief Widens ASCII characters sixteen at a time with SSE4.1, up to the first block of sixteen
+ * that holds a byte outside of ASCII.
+ *
+ * @returns The number of characters widened, which is a multiple of sixteen.
+ */
+template <typename CharacterType>
+CONTAINER_PRINTER_TARGET("sse4.1")
+std::size_t widen_ascii_sse41(const char* data, std::size_t size, CharacterType* output) noexcept
+{
+    static_assert(sizeof(CharacterType) == 2 || sizeof(CharacterType) == 4);
+
+    std::size_t index = 0;
+    for (; index + 16 <= size; index += 16) {
+        const auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index));
+        if (_mm_movemask_epi8(bytes) != 0) {
+            break;
+        }
+
+        auto* const out = reinterpret_cast<__m128i*>(output + index);
+        if constexpr (sizeof(CharacterType) == 2) {
+            _mm_storeu_si128(out, _mm_cvtepu8_epi16(bytes));
+            _mm_storeu_si128(out + 1, _mm_cvtepu8_epi16(_mm_srli_si128(bytes, 8)));
+        } else {
+            _mm_storeu_si128(out, _mm_cvtepu8_epi32(bytes));
+            _mm_storeu_si128(out + 1, _mm_cvtepu8_epi32(_mm_srli_si128(bytes, 4)));
+            _mm_storeu_si128(out + 2, _mm_cvtepu8_epi32(_mm_srli_si128(bytes, 8)));
+            _mm_storeu_si128(out + 3, _mm_cvtepu8_epi32(_mm_srli_si128(bytes, 12)));
+        }
+    }
+
+    return index;
+}
+#endif
+} // namespace simd
+
+/**
+ * @brief Widens the leading run of ASCII characters in the given text.
+ *
+ * @returns The number of characters widened, which stops short of the first byte that isn't ASCII.
+ */
+template <typename CharacterType>
+std::size_t widen_ascii(const char* data, std::size_t size, CharacterType* output) noexcept
+{
+    std::size_t index = 0;
+
+#if defined(CONTAINER_PRINTER_HAS_X86_SIMD)
+    if (size >= 16 && simd::active_instruction_set() != simd::instruction_set::scalar) {
+        index = simd::widen_ascii_sse41(data, size, output);
+    }
+#endif
+
+    // Eight bytes at a time, for as long as none of them has its high bit set.
+    for (; index + 8 <= size; index += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, data + index, sizeof(word));
+
+        if ((word & 0x8080808080808080u) != 0) {
+            break;
+        }
+
+        for (std::size_t offset = 0; offset < 8; ++offset) {
+            output[index + offset] = static_cast<CharacterType>(data[index + offset]);
+        }
+    }
+
+    for (; index < size && static_cast<unsigned char>(data[index]) < 0x80; ++index) {
+        output[index] = static_cast<CharacterType>(data[index]);
+    }
+
+    return index;
+}
+
+/**
+ * @brief Decodes the UTF-8 sequence at the start of the given text, which must not be empty.
+ *
+ * A malformed sequence decodes to U+FFFD, and consumes only its longest valid prefix (at least one
+ * byte), as Unicode recommends; overlong forms, surrogates, and values past U+10FFFF are malformed.
+ *
+ * @returns The code point, and the number of bytes consumed.
+ */
+inline std::pair<char32_t, std::size_t> decode_utf8(std::string_view text) noexcept
+{
+    constexpr char32_t replacement = 0xFFFD;
+
+    const auto lead = static_cast<unsigned char>(text[0]);
+    if (lead < 0x80) {
+        return { lead, 1 };
+    }
+
+    std::size_t length = 0;
+    unsigned char lower = 0x80;
+    unsigned char upper = 0xBF;
+
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        length = 2;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        length = 3;
+        lower = lead == 0xE0 ? 0xA0 : lower;
+        upper = lead == 0xED ? 0x9F : upper;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        length = 4;
+        lower = lead == 0xF0 ? 0x90 : lower;
+        upper = lead == 0xF4 ? 0x8F : upper;
+    } else {
+        return { replacement, 1 };
+    }
+
+    auto code_point = static_cast<char32_t>(lead & (0xFF >> (length + 1)));
+
+    for (std::size_t index = 1; index < length; ++index) {
+        if (index == text.size()) {
+            return { replacement, index };
+        }
+
+        const auto byte = static_cast<unsigned char>(text[index]);
+        if (byte < lower || byte > upper) {
+            return { replacement, index };
+        }
+
+        code_point = (code_point << 6) | (byte & 0x3F);
+        lower = 0x80;
+        upper = 0xBF;
+    }
+
+    return { code_point, length };
+}
+
+/**
+ * @brief Decodes UTF-8 text and writes it to a stream or sink of wider characters: as UTF-16 if
+ * the character type is sixteen bits wide, and as UTF-32 otherwise. Runs of ASCII, which are by
+ * far the most common, are widened in bulk. Sinks of `char8_t` receive the text unchanged.
+ */
+template <typename StreamType> void write_utf8(StreamType& stream, std::string_view text)
+{
+    using char_type = typename StreamType::char_type;
+
+    constexpr std::size_t block_size = 128;
+    char_type block[block_size];
+    std::size_t used = 0;
+
+    const auto flush = [&stream, &block, &used] {
+        write_literal(stream, std::basic_string_view<char_type>{ block, used });
+        used = 0;
+    };
+
+    if constexpr (sizeof(char_type) == 1) {
+        while (!text.empty()) {
+            used = std::min(text.size(), block_size);
+            std::memcpy(block, text.data(), used);
+
+            text.remove_prefix(used);
+            flush();
+        }
+    } else {
+        while (!text.empty()) {
+            const auto room = std::min(text.size(), block_size - used);
+            const auto widened = widen_ascii(text.data(), room, block + used);
+
+            used += widened;
+            text.remove_prefix(widened);
+
+            if (text.empty()) {
+                break;
+            }
+
+            // Leave room for a surrogate pair.
+            if (used + 2 > block_size) {
+                flush();
+            }
+
+            if (static_cast<unsigned char>(text[0]) < 0x80) {
+                continue;
+            }
+
+            const auto [code_point, length] = decode_utf8(text);
+            text.remove_prefix(length);
+
+            if (sizeof(char_type) == 2 && code_point >= 0x10000) {
+                const auto offset = code_point - 0x10000;
+                block[used++] = static_cast<char_type>(0xD800 + (offset >> 10));
+                block[used++] = static_cast<char_type>(0xDC00 + (offset & 0x3FF));
+            } else {
+                block[used++] = static_cast<char_type>(code_point);
+            }
+        }
+
+        if (used != 0) {
+            flush();
+        }
+    }
+}
+
+/**
+ * @brief Writes one integer or floating-point element through a `block_writer<...>`.
+ */
+template <typename WriterType, typename SinkType, typename ElementType>
+void append_element(
+    WriterType& writer, SinkType& sink, ElementType element, const float_spec& spec)
+{
+    constexpr std::size_t element_size =
+        std::is_floating_point_v<ElementType> ? 64 : max_integer_length<ElementType>;
+
+    char digits[element_size];
+
+    if constexpr (std::is_floating_point_v<ElementType>) {
+        const auto* const last =
+            format_float(digits, digits + element_size, element, spec.format, spec.precision);
+
+        if (last == nullptr) {
+            writer.flush();
+            write_float(sink, element, spec);
+            return;
+        }
+
+        writer.append_ascii(digits, static_cast<std::size_t>(last - digits));
+    } else {
+        const auto* const first = format_integer(digits + element_size, element);
+        writer.append_ascii(first, static_cast<std::size_t>(digits + element_size - first));
+    }
+}
+
+/**
+ * @brief Bulk formatting kernel for contiguous ranges of arithmetic elements.
+ *
+ * Elements and separators are converted into a thread-local scratch buffer, which is handed to the
+ * sink once per block, rather than once per element and once per separator. Integers are
+ * converted a batch at a time with SIMD instructions, when the processor supports them.
+ */
+template <typename SinkType, typename ElementType>
+void write_contiguous(
+    SinkType& sink, const ElementType* data, std::size_t size,
+    std::basic_string_view<typename SinkType::char_type> separator, const float_spec& spec,
+    simd::instruction_set set = simd::active_instruction_set())
+{
+    using char_type = typename SinkType::char_type;
+
+    constexpr std::size_t element_size =
+        std::is_floating_point_v<ElementType> ? 64 : max_integer_length<ElementType>;
+
+    constexpr auto capacity = block_writer<SinkType>::capacity;
+
+    const auto separator_length = separator.size();
+    const auto stride = separator_length + element_size;
+
+    block_writer<SinkType> writer{ sink };
+
+    if (stride > capacity) {
+        // A separator that doesn't fit in a block along with an element is written on its own.
+        for (std::size_t index = 0; index < size; ++index) {
+            if (index != 0) {
+                writer.write(separator.data(), separator_length);
+            }
+
+            writer.reserve(element_size);
+            append_element(writer, sink, data[index], spec);
+        }
+
+        writer.flush();
+        return;
+    }
+
+    std::size_t index = 0;
+    if constexpr (simd::is_batchable_v<ElementType>) {
+        // The batch may write up to eight characters past the end of the last number.
+        constexpr auto batch_slack = sizeof(std::uint64_t);
+
+        if (set != simd::instruction_set::scalar &&
+            simd::batch_size * stride + batch_slack <= capacity) {
+            using unsigned_type = std::make_unsigned_t<ElementType>;
+
+            simd::digit_batch batch;
+            std::uint32_t magnitudes[simd::batch_size];
+            bool is_negative[simd::batch_size];
+
+            for (; index + simd::batch_size <= size; index += simd::batch_size) {
+                writer.reserve(simd::batch_size * stride + batch_slack);
+
+                bool fits = true;
+                for (std::size_t lane = 0; lane < simd::batch_size; ++lane) {
+                    const auto value = data[index + lane];
+                    is_negative[lane] = value < 0;
+
+                    const auto magnitude = is_negative[lane]
+                                               ? static_cast<unsigned_type>(
+                                                     0 - static_cast<unsigned_type>(value))
+                                               : static_cast<unsigned_type>(value);
+
+                    fits = fits && magnitude <= std::numeric_limits<std::uint32_t>::max();
+                    magnitudes[lane] = static_cast<std::uint32_t>(magnitude);
+                }
+
+                if (!fits) {
+                    for (std::size_t lane = 0; lane < simd::batch_size; ++lane) {
+                        if (index + lane != 0) {
+                            writer.append(separator.data(), separator_length);
+                        }
+
+                        append_element(writer, sink, data[index + lane], spec);
+                    }
+
+                    continue;
+                }
+
+                simd::convert(magnitudes, batch, set);
+
+                for (std::size_t lane = 0; lane < simd::batch_size; ++lane) {
+                    if (index + lane != 0) {
+                        writer.append(separator.data(), separator_length);
+                    }
+
+                    if (is_negative[lane]) {
+                        writer.append_ascii("-", 1);
+                    }
+
+                    if constexpr (std::is_same_v<char_type, char>) {
+                        writer.advance(simd::emit(writer.position(), batch, lane));
+                    } else {
+                        char digits[simd::max_digits + sizeof(std::uint64_t)];
+                        const auto length = simd::emit(digits, batch, lane);
+                        writer.append_ascii(digits, length);
+                    }
+                }
+            }
+        }
+    }
+
+    if constexpr (std::is_floating_point_v<ElementType>) {
+        for (; index < size; ++index) {
+            writer.reserve(stride);
+
+            if (index != 0) {
+                writer.append(separator.data(), separator_length);
+            }
+
+            append_element(writer, sink, data[index], spec);
+        }
+    } else {
+        // Integers never overflow their bound, so the capacity need only be checked once for a
+        // group of elements that is known to fit in the block.
+        const auto group_size = capacity / stride;
+
+        while (index < size) {
+            const auto group_end = std::min(size, index + group_size);
+            writer.reserve((group_end - index) * stride);
+
+            for (; index < group_end; ++index) {
+                if (index != 0) {
+                    writer.append(separator.data(), separator_length);
+                }
+
+                append_element(writer, sink, data[index], spec);
+            }
+        }
+    }
+
+    writer.flush();
+}
+
+/**
+ * @returns The number of threads to use, given the options and the number of pieces of work that
+ * there are to share out.
+ */
+inline std::size_t resolve_thread_count(const parallel_options& parallel, std::size_t work_count)
+{
+    auto thread_count = parallel.thread_count;
+    if (thread_count == 0) {
+        thread_count = std::thread::hardware_concurrency();
+    }
+
+    return std::max<std::size_t>(1, std::min(thread_count, work_count));
+}
+
+/**
+ * @brief Threads that are started on first use and then kept for the lifetime of the program, so
+ * that parallel prints borrow threads, rather than starting and joining threads of their own every
+ * time. Jobs run in the order in which they were submitted; when no thread is idle, another one is
+ * started.
+ */
+class thread_pool
+{
+  public:
+    static thread_pool& instance()
+    {
+        static thread_pool pool;
+        return pool;
+    }
+
+    ~thread_pool() noexcept
+    {
+        {
+            const std::lock_guard<std::mutex> lock{ m_mutex };
+            m_is_stopping = true;
+        }
+
+        m_wakeup.notify_all();
+
+        for (auto& thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    /**
+     * @brief Queues a job. Should no thread be available, and none can be started, the job waits
+     * for one of the threads that are already running; callers mustn't rely on it to make progress.
+     */
+    void submit(std::function<void()> job)
+    {
+        {
+            const std::lock_guard<std::mutex> lock{ m_mutex };
+            m_jobs.push_back(std::move(job));
+
+            if (m_idle_count < m_jobs.size()) {
+                try {
+                    m_threads.emplace_back([this] { run(); });
+                } catch (...) {
+                }
+            }
+        }
+
+        m_wakeup.notify_one();
+    }
+
+  private:
+    thread_pool() = default;
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock{ m_mutex };
+
+        while (true) {
+            ++m_idle_count;
+            m_wakeup.wait(lock, [this] { return m_is_stopping || !m_jobs.empty(); });
+            --m_idle_count;
+
+            if (m_jobs.empty()) {
+                return;
+            }
+
+            auto job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+
+            lock.unlock();
+            job();
+            lock.lock();
+        }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::deque<std::function<void()>> m_jobs;
+    std::vector<std::thread> m_threads;
+    std::size_t m_idle_count = 0;
+    bool m_is_stopping = false;
+};
+
+/**
+ * @brief A minimal work-stealing executor.
+ *
+ * Every thread owns a queue. Tasks that are spawned from a thread are pushed onto the back of that
+ * thread's queue and are taken from the back again by the owner, while idle threads steal from the
+ * front of the other queues. The thread that owns the executor takes part through `wait()`; the
+ * others are borrowed from the `thread_pool`, and are handed back when the executor is destroyed.
+ */
+class work_stealing_executor
+{
+  public:
+    explicit work_stealing_executor(std::size_t thread_count)
+        : m_state{ std::make_shared<state>(thread_count) }
+    {
+        for (std::size_t index = 1; index < thread_count; ++index) {
+            // The helpers share ownership of the state, since they may only get to run after the
+            // executor is gone, in which case they return to the pool straight away.
+            thread_pool::instance().submit([state = m_state, index] { state->work(index); });
+        }
+    }
+
+    ~work_stealing_executor() noexcept
+    {
+        m_state->is_stopping = true;
+        m_state->notify(true);
+    }
+
+    work_stealing_executor(const work_stealing_executor&) = delete;
+    work_stealing_executor& operator=(const work_stealing_executor&) = delete;
+
+    template <typename TaskType> void spawn(TaskType&& task)
+    {
+        const auto& slot = current_slot();
+        auto& queue = *m_state->queues[slot.owner == m_state.get() ? slot.index : 0];
+
+        m_state->pending.fetch_add(1, std::memory_order_relaxed);
+
+        {
+            const std::lock_guard<std::mutex> lock{ queue.mutex };
+            queue.tasks.emplace_back(std::forward<TaskType>(task));
+        }
+
+        m_state->notify(false);
+    }
+
+    /**
+     * @brief Helps out until every task, including the tasks spawned by other tasks, has run. While
+     * there is nothing to help with, the calling thread blocks, rather than spinning.
+     *
+     * Tasks must not throw; an exception that escapes from a task terminates the program, just as
+     * it would from the `noexcept` members of the `default_formatter<...>` that tasks print with.
+     */
+    void wait()
+    {
+        auto& state = *m_state;
+        const slot_guard guard{ &state, 0 };
+
+        while (state.pending.load(std::memory_order_acquire) != 0) {
+            if (!state.run_one(0)) {
+                std::unique_lock<std::mutex> lock{ state.idle_mutex };
+                state.idle.wait(lock, [&state] {
+                    return state.pending.load(std::memory_order_acquire) == 0 ||
+                           state.has_queued_tasks();
+                });
+            }
+        }
+    }
+
+  private:
+    struct task_queue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    struct state;
+
+    struct slot
+    {
+        const state* owner = nullptr;
+        std::size_t index = 0;
+    };
+
+    /**
+     * @brief Records which queue the current thread owns, for as long as the guard lives.
+     */
+    class slot_guard
+    {
+      public:
+        slot_guard(const state* owner, std::size_t index) noexcept : m_previous{ current_slot() }
+        {
+            current_slot() = { owner, index };
+        }
+
+        ~slot_guard() noexcept
+        {
+            current_slot() = m_previous;
+        }
+
+        slot_guard(const slot_guard&) = delete;
+        slot_guard& operator=(const slot_guard&) = delete;
+
+      private:
+        slot m_previous;
+    };
+
+    static slot& current_slot() noexcept
+    {
+        thread_local slot current;
+        return current;
+    }
+
+    /**
+     * @brief The queues, and the bookkeeping, that the executor shares with its helper threads.
+     */
+    struct state
+    {
+        explicit state(std::size_t thread_count) : queues(thread_count)
+        {
+            for (auto& queue : queues) {
+                queue = std::make_unique<task_queue>();
+            }
+        }
+
+        bool take(std::size_t index, std::function<void()>& task)
+        {
+            {
+                auto& own = *queues[index];
+                const std::lock_guard<std::mutex> lock{ own.mutex };
+
+                if (!own.tasks.empty()) {
+                    task = std::move(own.tasks.back());
+                    own.tasks.pop_back();
+                    return true;
+                }
+            }
+
+            for (std::size_t offset = 1; offset < queues.size(); ++offset) {
+                auto& victim = *queues[(index + offset) % queues.size()];
+                const std::lock_guard<std::mutex> lock{ victim.mutex };
+
+                if (!victim.tasks.empty()) {
+                    task = std::move(victim.tasks.front());
+                    victim.tasks.pop_front();
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        bool has_queued_tasks()
+        {
+            for (const auto& queue : queues) {
+                const std::lock_guard<std::mutex> lock{ queue->mutex };
+                if (!queue->tasks.empty()) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        /**
+         * @brief Wakes up idle threads. The idle mutex is taken first, so that a thread that has
+         * just found nothing to do, and is about to block, can't miss the notification.
+         */
+        void notify(bool is_done)
+        {
+            {
+                const std::lock_guard<std::mutex> lock{ idle_mutex };
+            }
+
+            if (is_done) {
+                idle.notify_all();
+            } else {
+                idle.notify_one();
+            }
+        }
+
+        bool run_one(std::size_t index)
+        {
+            std::function<void()> task;
+            if (!take(index, task)) {
+                return false;
+            }
+
+            task();
+
+            if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                notify(true);
+            }
+
+            return true;
+        }
+
+        void work(std::size_t index)
+        {
+            const slot_guard guard{ this, index };
+
+            while (!is_stopping) {
+                if (!run_one(index)) {
+                    std::unique_lock<std::mutex> lock{ idle_mutex };
+                    idle.wait(lock, [this] { return is_stopping || has_queued_tasks(); });
+                }
+            }
+        }
+
+        std::vector<std::unique_ptr<task_queue>> queues;
+
+        std::atomic<std::size_t> pending{ 0 };
+        std::atomic<bool> is_stopping{ false };
+
+        std::mutex idle_mutex;
+        std::condition_variable idle;
+    };
+
+    std::shared_ptr<state> m_state;
+};
+
+/**
+ * @brief Splits a contiguous range into chunks, formats the chunks into separate buffers on the
+ * threads of a `work_stealing_executor`, and then writes the buffers to the sink in order.
+ */
+template <typename SinkType, typename ElementType>
+void write_contiguous_parallel(
+    SinkType& sink, const ElementType* data, std::size_t size,
+    std::basic_string_view<typename SinkType::char_type> separator, const float_spec& spec,
+    const parallel_options& parallel)
+{
+    using char_type = typename SinkType::char_type;
+    using chunk_sink_type = sinks::string_sink<char_type>;
+
+    const auto chunk_size = parallel.chunk_size == 0 ? size : parallel.chunk_size;
+    const auto chunk_count = (size + chunk_size - 1) / chunk_size;
+
+    std::vector<std::basic_string<char_type>> chunks(chunk_count);
+    std::exception_ptr failure;
+    std::atomic<bool> has_failed{ false };
+
+    {
+        work_stealing_executor executor{ resolve_thread_count(parallel, chunk_count) };
+
+        for (std::size_t chunk = 0; chunk < chunk_count; ++chunk) {
+            executor.spawn([&, chunk]() noexcept {
+                if (has_failed) {
+                    return;
+                }
+
+                try {
+                    const auto begin = chunk * chunk_size;
+                    const auto count = std::min(chunk_size, size - begin);
+
+                    chunk_sink_type chunk_sink{ chunks[chunk] };
+                    if (chunk != 0) {
+                        chunk_sink.write(separator.data(), separator.size());
+                    }
+
+                    write_contiguous(chunk_sink, data + begin, count, separator, spec);
+                } catch (...) {
+                    if (!has_failed.exchange(true)) {
+                        failure = std::current_exception();
+                    }
+                }
+            });
+        }
+
+        executor.wait();
+    }
+
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+
+    for (const auto& chunk : chunks) {
+        sink.write(chunk.data(), chunk.size());
+    }
+}
+
+/**
+ * @brief Writes a contiguous range of numbers to a sink, in parallel if the options ask for it and
+ * the range is large enough.
+ */
+template <typename SinkType, typename ElementType>
+void write_contiguous_range(
+    SinkType& sink, const ElementType* data, std::size_t size,
+    std::basic_string_view<typename SinkType::char_type> separator, const format_options& options)
+{
+    if constexpr (traits::is_counting_sink_v<SinkType> && is_numeric_integer_v<ElementType>) {
+        if (size != 0) {
+            std::size_t length = (size - 1) * separator.size();
+            for (std::size_t index = 0; index < size; ++index) {
+                length += integer_length(data[index]);
+            }
+
+            sink.skip(length);
+        }
+
+        return;
+    }
+
+    auto spec = make_float_spec(options.floats, options.float_precision);
+    if constexpr (std::is_floating_point_v<ElementType>) {
+        if (options.floats == float_format::automatic) {
+            spec.precision = sink.float_precision();
+        }
+    }
+
+    const auto& parallel = options.parallel;
+    if (parallel.thread_count != 1 && size >= parallel.threshold && size != 0) {
+        write_contiguous_parallel(sink, data, size, separator, spec, parallel);
+    } else {
+        write_contiguous(sink, data, size, separator, spec);
+    }
+}
+
+/**
+ * @brief Type trait to determine whether a type is a std::pair<...> or a std::tuple<...>.
+ */
+template <typename Type> struct is_tuple_like : public std::false_type
+{
+};
+
+template <typename FirstType, typename SecondType>
+struct is_tuple_like<std::pair<FirstType, SecondType>> : public std::true_type
+{
+};
+
+template <typename... Args> struct is_tuple_like<std::tuple<Args...>> : public std::true_type
+{
+};
+
+template <typename Type> constexpr bool is_tuple_like_v = is_tuple_like<Type>::value;
+
+/**
+ * @brief Type trait to determine whether the size of a container can be queried in constant time.
+ */
+template <typename Type, typename = void> struct has_size : public std::false_type
+{
+};
+
+template <typename Type>
+struct has_size<Type, std::void_t<decltype(std::size(std::declval<const Type&>()))>>
+    : public std::true_type
+{
+};
+
+template <typename Type> constexpr bool has_size_v = has_size<Type>::value;
+
+/**
+ * @brief Estimates the amount of work involved in printing a value, counted in elements.
+ *
+ * Only containers of containers are traversed; the weight of a container of plain elements is
+ * simply its size. Callers that only need to know whether the weight reaches a certain limit can
+ * pass that limit, so that the traversal stops as soon as it does; the result is then exact below
+ * the limit, and at least the limit otherwise.
+ */
+template <typename Type>
+std::size_t
+weight(const Type& value, std::size_t limit = std::numeric_limits<std::size_t>::max())
+{
+    if constexpr (is_tuple_like_v<Type>) {
+        return std::apply(
+            [limit](const auto&... members) {
+                std::size_t sum = 0;
+                ((sum = sum < limit ? sum + weight(members, limit - sum) : sum), ...);
+
+                return sum;
+            },
+            value);
+    } else if constexpr (traits::is_printable_as_container_v<Type>) {
+        using element_type = std::decay_t<decltype(*std::begin(value))>;
+
+        std::size_t sum = 0;
+        if constexpr (
+            is_tuple_like_v<element_type> || traits::is_printable_as_container_v<element_type>) {
+            for (const auto& element : value) {
+                sum += weight(element, limit - sum);
+                if (sum >= limit) {
+                    break;
+                }
+            }
+        } else if constexpr (has_size_v<Type>) {
+            sum = std::size(value);
+        } else {
+            sum = static_cast<std::size_t>(std::distance(std::begin(value), std::end(value)));
+        }
+
+        return std::max<std::size_t>(1, sum);
+    } else {
+        return 1;
+    }
+}
+
+/**
+ * @brief The output of a single task: its own text, plus the output of every task that it spawned,
+ * keyed by the offset in the text at which that output belongs.
+ */
+template <typename CharacterType> struct task_output
+{
+    std::basic_string<CharacterType> text;
+    std::vector<std::pair<std::size_t, std::unique_ptr<task_output>>> children;
+
+    task_output& add_child()
+    {
+        children.emplace_back(text.size(), std::make_unique<task_output>());
+        return *children.back().second;
+    }
+};
+
+/**
+ * @brief Writes the output of a task, with the output of its children spliced in, to the sink.
+ */
+template <typename SinkType, typename CharacterType>
+void write_output(SinkType& sink, const task_output<CharacterType>& output)
+{
+    std::size_t position = 0;
+    for (const auto& [offset, child] : output.children) {
+        sink.write(output.text.data() + position, offset - position);
+        write_output(sink, *child);
+        position = offset;
+    }
+
+    sink.write(output.text.data() + position, output.text.size() - position);
+}
+
+/**
+ * @brief Type trait to determine whether a sink is backed by a stream.
+ */
+template <typename SinkType, typename = void> struct has_stream : public std::false_type
+{
+};
+
+template <typename SinkType>
+struct has_stream<SinkType, std::void_t<decltype(std::declval<SinkType&>().stream())>>
+    : public std::true_type
+{
+};
+
+/**
+ * @brief The state of the sink or stream that the output is ultimately written to, captured so
+ * that the output can be formatted into a string first, exactly as that sink would have done.
+ */
+template <typename CharacterType> struct sink_profile
+{
+    bool has_plain_integers = true;
+    bool has_plain_floats = true;
+    bool has_utf8_text = true;
+    int float_precision = 6;
+
+    /**
+     * @brief The stream whose format flags apply to elements that are printed through their own
+     * `operator<<`, if the sink is backed by a stream.
+     */
+    const std::basic_ios<CharacterType>* origin = nullptr;
+};
+
+template <typename CharacterType, bool IsStreamBacked> class profiled_sink;
+
+template <typename SinkType>
+sink_profile<typename SinkType::char_type> make_sink_profile(SinkType& sink)
+{
+    sink_profile<typename SinkType::char_type> profile;
+    profile.has_plain_integers = sink.has_plain_integers();
+    profile.has_plain_floats = sink.has_plain_floats();
+    profile.has_utf8_text = sink.has_utf8_text();
+    profile.float_precision = sink.float_precision();
+
+    if constexpr (has_stream<SinkType>::value) {
+        profile.origin = &sink.stream();
+    }
+
+    return profile;
+}
+
+template <typename CharacterType, bool IsStreamBacked>
+sink_profile<CharacterType> make_sink_profile(profiled_sink<CharacterType, IsStreamBacked>& sink)
+{
+    return sink.profile();
+}
+
+/**
+ * @brief Sink that appends to a string, while formatting elements as the sink or stream that the
+ * string is ultimately written to would have. The tasks of a parallel traversal, and atomic writes,
+ * are formatted through this sink.
+ *
+ * Only a sink that is backed by a stream formats elements through the stream's own state, so
+ * that printing to any other sink never involves the iostreams library.
+ */
+template <typename CharacterType, bool IsStreamBacked = false>
+class profiled_sink
+    : public sinks::sink_base<profiled_sink<CharacterType, IsStreamBacked>, CharacterType>
+{
+  public:
+    profiled_sink(
+        std::basic_string<CharacterType>& text, const sink_profile<CharacterType>& profile) noexcept
+        : m_text{ text }, m_profile{ profile }
+    {
+    }
+
+    using sinks::sink_base<profiled_sink, CharacterType>::write;
+
+    void put(CharacterType character)
+    {
+        m_text.push_back(character);
+    }
+
+    void write(const CharacterType* data, std::size_t size)
+    {
+        m_text.append(data, size);
+    }
+
+    CharacterType* reserve_direct(std::size_t size)
+    {
+        const auto old_size = m_text.size();
+        m_text.resize(old_size + size);
+
+        return m_text.data() + old_size;
+    }
+
+    void commit_direct(const CharacterType* end) noexcept
+    {
+        m_text.resize(static_cast<std::size_t>(end - m_text.data()));
+    }
+
+    bool has_plain_integers() const noexcept
+    {
+        return m_profile.has_plain_integers;
+    }
+
+    bool has_plain_floats() const noexcept
+    {
+        return m_profile.has_plain_floats;
+    }
+
+    bool has_utf8_text() const noexcept
+    {
+        return m_profile.has_utf8_text;
+    }
+
+    int float_precision() const noexcept
+    {
+        return m_profile.float_precision;
+    }
+
+    const sink_profile<CharacterType>& profile() const noexcept
+    {
+        return m_profile;
+    }
+
+    /**
+     * @brief Formats the element through a string stream that carries the format flags of the
+     * originating stream. The string stream is kept around for the rest of the task.
+     */
+    template <typename Type> void insert_formatted(const Type& value)
+    {
+        if constexpr (IsStreamBacked) {
+            stream_formatter<CharacterType>::write_like(*this, m_profile.origin, m_stream, value);
+        } else {
+            sinks::sink_base<profiled_sink, CharacterType>::insert_formatted(value);
+        }
+    }
+
+  private:
+    std::basic_string<CharacterType>& m_text;
+    const sink_profile<CharacterType>& m_profile;
+    std::shared_ptr<void> m_stream;
+};
+
+/**
+ * @brief The sink that the tasks of a parallel traversal format their output through.
+ */
+template <typename SinkType> struct task_sink
+{
+    using type = profiled_sink<typename SinkType::char_type, has_stream<SinkType>::value>;
+};
+
+template <typename CharacterType, bool IsStreamBacked>
+struct task_sink<profiled_sink<CharacterType, IsStreamBacked>>
+{
+    using type = profiled_sink<CharacterType, IsStreamBacked>;
+};
+
+/**
+ * @brief State shared by all of the tasks of a parallel traversal.
+ */
+template <typename SinkType> struct parallel_context
+{
+    work_stealing_executor& executor;
+    sink_profile<typename SinkType::char_type> profile;
+
+    /**
+     * @brief The options that the tasks format their elements with; these are always serial.
+     */
+    format_options options;
+
+    std::size_t chunk_size;
+    std::size_t task_size;
+};
+
+template <typename SinkType, typename ContainerType>
+void format_in_parallel(
+    const parallel_context<SinkType>& context, task_output<typename SinkType::char_type>& output,
+    const ContainerType& container,
+    const decorator::wrapper<typename SinkType::char_type>& decorators =
+        decorator::delimiters<ContainerType, typename SinkType::char_type>::values);
+
+/**
+ * @brief Prints a single element of a parallel traversal, either inline or, if it is a container
+ * with enough work in it, as a task of its own.
+ */
+template <typename SinkType, typename FormatterType, typename ElementType>
+void format_element_in_parallel(
+    const parallel_context<SinkType>& context, task_output<typename SinkType::char_type>& output,
+    SinkType& sink, const FormatterType& formatter, const ElementType& element,
+    std::size_t element_weight)
+{
+    if constexpr (
+        is_tuple_like_v<ElementType> || traits::is_printable_as_container_v<ElementType>) {
+        if (element_weight >= context.task_size) {
+            auto& child = output.add_child();
+            context.executor.spawn(
+                [&context, &child, &element] { format_in_parallel(context, child, element); });
+
+            return;
+        }
+    }
+
+    formatter.print_element(sink, element);
+}
+
+/**
+ * @brief Prints a container as part of a parallel traversal.
+ *
+ * Large elements become tasks of their own, and runs of small elements are grouped into chunks of
+ * roughly `chunk_size` elements, each of which also becomes a task. Finding the chunk boundaries
+ * takes a single pass over the iterators, so node-based containers are split just as well.
+ */
+template <typename SinkType, typename ContainerType>
+void format_in_parallel(
+    const parallel_context<SinkType>& context, task_output<typename SinkType::char_type>& output,
+    const ContainerType& container,
+    const decorator::wrapper<typename SinkType::char_type>& decorators)
+{
+    using sink_type = SinkType;
+    using formatter_type = default_formatter<ContainerType, sink_type>;
+
+    sink_type sink{ output.text, context.profile };
+    const formatter_type formatter{ context.options, decorators };
+
+    formatter.print_prefix(sink);
+
+    if constexpr (is_tuple_like_v<ContainerType>) {
+        std::apply(
+            [&](const auto&... members) {
+                std::size_t index = 0;
+                ((index++ == 0 ? void() : formatter.print_delimiter(sink),
+                  format_element_in_parallel(
+                      context, output, sink, formatter, members,
+                      weight(members, context.task_size))),
+                 ...);
+            },
+            container);
+    } else {
+        auto iterator = std::begin(container);
+        const auto end = std::end(container);
+
+        // Every element is weighed once, and only up to the task size, since all that matters is
+        // whether it reaches that size.
+        const auto weigh = [&context](const auto& element) {
+            return weight(element, context.task_size);
+        };
+
+        bool is_first = true;
+        std::size_t element_weight = iterator != end ? weigh(*iterator) : 0;
+
+        while (iterator != end) {
+            if (element_weight >= context.task_size) {
+                if (!is_first) {
+                    formatter.print_delimiter(sink);
+                }
+
+                format_element_in_parallel(
+                    context, output, sink, formatter, *iterator, element_weight);
+
+                ++iterator;
+                element_weight = iterator != end ? weigh(*iterator) : 0;
+
+                is_first = false;
+                continue;
+            }
+
+            const auto chunk_begin = iterator;
+
+            std::size_t chunk_weight = 0;
+            while (iterator != end && chunk_weight < context.chunk_size) {
+                if (element_weight >= context.task_size) {
+                    break;
+                }
+
+                chunk_weight += element_weight;
+
+                ++iterator;
+                element_weight = iterator != end ? weigh(*iterator) : 0;
+            }
+
+            const auto print_chunk = [formatter, chunk_begin, chunk_end = iterator,
+                                      is_first](sink_type& chunk_sink) {
+                for (auto element = chunk_begin; element != chunk_end; ++element) {
+                    if (element != chunk_begin || !is_first) {
+                        formatter.print_delimiter(chunk_sink);
+                    }
+
+                    formatter.print_element(chunk_sink, *element);
+                }
+            };
+
+            if (chunk_weight >= context.chunk_size) {
+                auto& child = output.add_child();
+                context.executor.spawn([&context, &child, print_chunk] {
+                    sink_type chunk_sink{ child.text, context.profile };
+                    print_chunk(chunk_sink);
+                });
+            } else {
+                print_chunk(sink);
+            }
+
+            is_first = false;
+        }
+    }
+
+    formatter.print_suffix(sink);
+}
+
+/**
+ * @brief Prints a container on a work-stealing executor, provided that it holds enough work.
+ *
+ * @returns False if nothing was printed, in which case the caller should take the serial path.
+ */
+template <typename SinkType, typename ContainerType>
+bool print_in_parallel(
+    SinkType& sink, const ContainerType& container, const format_options& options,
+    const decorator::wrapper<typename SinkType::char_type>& decorators)
+{
+    using char_type = typename SinkType::char_type;
+
+    const auto& parallel = options.parallel;
+
+    constexpr auto unlimited = std::numeric_limits<std::size_t>::max();
+
+    const auto task_size = std::max<std::size_t>(1, parallel.task_size);
+    const auto chunk_size = parallel.chunk_size == 0 ? unlimited : parallel.chunk_size;
+
+    // The weight only matters up to the threshold, and up to the point at which every thread would
+    // have work, so the traversal stops once it reaches both.
+    const auto work_size = std::min(task_size, chunk_size);
+    const auto max_thread_count = resolve_thread_count(parallel, unlimited);
+    const auto limit = std::max(
+        parallel.threshold,
+        work_size > unlimited / max_thread_count ? unlimited : work_size * max_thread_count);
+
+    const auto total_weight = weight(container, limit);
+    if (total_weight < parallel.threshold || total_weight == 0) {
+        return false;
+    }
+
+    format_options serial_options = options;
+    serial_options.parallel.thread_count = 1;
+
+    task_output<char_type> root;
+    {
+        work_stealing_executor executor{ resolve_thread_count(
+            parallel, total_weight / work_size + 1) };
+
+        const parallel_context<typename task_sink<SinkType>::type> context{
+            executor, make_sink_profile(sink), serial_options, chunk_size, task_size
+        };
+
+        format_in_parallel(context, root, container, decorators);
+        executor.wait();
+    }
+
+    write_output(sink, root);
+
+    return true;
+}
+
+/**
+ * @brief Type trait to determine the number of elements in a fixed-size array, which is zero for
+ * any other type.
+ */
+template <typename Type> struct fixed_extent : public std::integral_constant<std::size_t, 0>
+{
+};
+
+template <typename ElementType, std::size_t Extent>
+struct fixed_extent<std::array<ElementType, Extent>>
+    : public std::integral_constant<std::size_t, Extent>
+{
+};
+
+template <typename ElementType, std::size_t Extent>
+struct fixed_extent<ElementType[Extent]> : public std::integral_constant<std::size_t, Extent>
+{
+};
+
+/**
+ * @returns The length of the prefix and suffix, plus that of the given number of separators, that
+ * surround the elements of the given container.
+ */
+template <typename ContainerType, typename CharacterType>
+constexpr std::size_t delimiters_length(std::size_t element_count) noexcept
+{
+    constexpr auto values = decorator::delimiters<ContainerType, CharacterType>::values;
+
+    return values.prefix.size() + values.suffix.size() +
+           (element_count == 0 ? 0 : (element_count - 1) * values.separator.size());
+}
+
+template <typename Type, typename CharacterType>
+constexpr std::size_t max_formatted_length() noexcept;
+
+template <typename CharacterType, typename... Types>
+constexpr std::size_t max_members_length() noexcept
+{
+    if constexpr (((max_formatted_length<Types, CharacterType>() != 0) && ...)) {
+        return (std::size_t{ 0 } + ... + max_formatted_length<Types, CharacterType>());
+    } else {
+        return 0;
+    }
+}
+
+template <typename CharacterType, typename TupleType> struct max_tuple_length;
+
+template <typename CharacterType, typename... Types>
+struct max_tuple_length<CharacterType, std::tuple<Types...>>
+    : public std::integral_constant<std::size_t, max_members_length<CharacterType, Types...>()>
+{
+};
+
+template <typename CharacterType, typename FirstType, typename SecondType>
+struct max_tuple_length<CharacterType, std::pair<FirstType, SecondType>>
+    : public std::integral_constant<
+          std::size_t, max_members_length<CharacterType, FirstType, SecondType>()>
+{
+};
+
+/**
+ * @returns An upper bound on the number of characters needed to print a value of the given type
+ * with the locale-free conversions, or zero if there is no such bound. Integers are bounded, and
+ * so are pairs, tuples, and fixed-size arrays of bounded values.
+ */
+template <typename Type, typename CharacterType>
+constexpr std::size_t max_formatted_length() noexcept
+{
+    if constexpr (!std::is_same_v<Type, std::remove_cv_t<Type>>) {
+        return max_formatted_length<std::remove_cv_t<Type>, CharacterType>();
+    } else if constexpr (is_numeric_integer_v<Type>) {
+        return max_integer_length<Type>;
+    } else if constexpr (is_tuple_like_v<Type>) {
+        constexpr auto members_length = max_tuple_length<CharacterType, Type>::value;
+        constexpr auto member_count = std::tuple_size_v<Type>;
+
+        if constexpr (members_length == 0 && member_count != 0) {
+            return 0;
+        } else {
+            return members_length + delimiters_length<Type, CharacterType>(member_count);
+        }
+    } else if constexpr (fixed_extent<Type>::value != 0) {
+        using element_type = std::remove_cv_t<std::remove_reference_t<
+            decltype(*std::begin(std::declval<const Type&>()))>>;
+
+        constexpr auto extent = fixed_extent<Type>::value;
+        constexpr auto element_length = max_formatted_length<element_type, CharacterType>();
+
+        if constexpr (element_length == 0) {
+            return 0;
+        } else {
+            return extent * element_length + delimiters_length<Type, CharacterType>(extent);
+        }
+    } else {
+        return 0;
+    }
+}
+
+/**
+ * @brief The largest element bound for which the bounded kernel is used; larger elements wouldn't
+ * leave enough room for a useful number of elements per block.
+ */
+inline constexpr std::size_t max_bounded_length = 1024;
+
+/**
+ * @brief True if values of the given type are bounded, and small enough for the bounded kernel.
+ */
+template <typename Type, typename CharacterType>
+constexpr bool is_bounded_v = max_formatted_length<Type, CharacterType>() != 0 &&
+                              max_formatted_length<Type, CharacterType>() <= max_bounded_length;
+
+/**
+ * @brief Base case for containers that can be written by the bounded kernel.
+ */
+template <typename ContainerType, typename StreamType, typename FormatterType, typename = void>
+constexpr bool is_bounded_formattable_v = false;
+
+/**
+ * @brief Sized containers of bounded elements qualify for the bounded kernel, as long as they are
+ * written to a sink with the default formatter.
+ */
+template <typename ContainerType, typename StreamType, typename FormatterType>
+constexpr bool is_bounded_formattable_v<
+    ContainerType, StreamType, FormatterType,
+    std::enable_if_t<
+        traits::is_sink_v<StreamType> && !traits::is_counting_sink_v<StreamType> &&
+        has_size_v<ContainerType> && !is_tuple_like_v<ContainerType> &&
+        std::is_same_v<FormatterType, default_formatter<ContainerType, StreamType>>>> =
+    is_bounded_v<
+        std::decay_t<decltype(*std::begin(std::declval<const ContainerType&>()))>,
+        typename StreamType::char_type>;
+
+/**
+ * @brief Type trait to determine whether a sink lets the caller write directly into its storage.
+ */
+template <typename SinkType, typename = void> struct has_direct_access : public std::false_type
+{
+};
+
+template <typename SinkType>
+struct has_direct_access<
+    SinkType, std::void_t<decltype(std::declval<SinkType&>().reserve_direct(std::size_t{}))>>
+    : public std::true_type
+{
+};
+
+template <typename CharacterType>
+CharacterType*
+append_literal(CharacterType* out, std::basic_string_view<CharacterType> literal) noexcept
+{
+    std::char_traits<CharacterType>::copy(out, literal.data(), literal.size());
+
+    return out + literal.size();
+}
+
+/**
+ * @brief Writes a bounded value, without any capacity checks; the caller must have made room for
+ * `max_formatted_length<...>()` characters.
+ *
+ * @returns A pointer one past the last character written.
+ */
+template <typename CharacterType, typename Type>
+CharacterType* append_bounded(CharacterType* out, const Type& value) noexcept
+{
+    if constexpr (is_numeric_integer_v<Type>) {
+        char digits[max_integer_length<Type>];
+
+        auto* const last = digits + sizeof(digits);
+        const auto* const first = format_integer(last, value);
+        const auto length = static_cast<std::size_t>(last - first);
+
+        if constexpr (std::is_same_v<CharacterType, char>) {
+            std::memcpy(out, first, length);
+        } else {
+            for (std::size_t index = 0; index < length; ++index) {
+                out[index] = static_cast<CharacterType>(first[index]);
+            }
+        }
+
+        return out + length;
+    } else {
+        using delimiters_type = decorator::delimiters<Type, CharacterType>;
+
+        out = append_literal(out, delimiters_type::values.prefix);
+
+        if constexpr (is_tuple_like_v<Type>) {
+            std::apply(
+                [&out, index = std::size_t{ 0 }](const auto&... members) mutable {
+                    ((out = append_bounded(
+                          index++ == 0 ? out
+                                       : append_literal(out, delimiters_type::values.separator),
+                          members)),
+                     ...);
+                },
+                value);
+        } else {
+            bool is_first = true;
+            for (const auto& element : value) {
+                if (!is_first) {
+                    out = append_literal(out, delimiters_type::values.separator);
+                }
+
+                out = append_bounded(out, element);
+                is_first = false;
+            }
+        }
+
+        return append_literal(out, delimiters_type::values.suffix);
+    }
+}
+
+/**
+ * @brief Kernel for sized containers of bounded elements.
+ *
+ * Since every element, plus its separator, is known to fit in a fixed number of characters, room
+ * for the entire container is made up front and the elements are written without any per-element
+ * capacity checks. Sinks that allow it are written to directly, and trimmed afterwards; others are
+ * written to through a `block_writer<...>`, with one check per block.
+ */
+template <typename SinkType, typename ContainerType>
+void write_bounded_range(
+    SinkType& sink, const ContainerType& container,
+    std::basic_string_view<typename SinkType::char_type> separator)
+{
+    using char_type = typename SinkType::char_type;
+    using element_type =
+        std::decay_t<decltype(*std::begin(std::declval<const ContainerType&>()))>;
+
+    constexpr auto element_length = max_formatted_length<element_type, char_type>();
+
+    const auto separator_length = separator.size();
+    const auto stride = element_length + separator_length;
+    const auto size = static_cast<std::size_t>(std::size(container));
+
+    auto element = std::begin(container);
+    const auto end = std::end(container);
+
+    if constexpr (has_direct_access<SinkType>::value) {
+        auto* const first = sink.reserve_direct(size * stride);
+        auto* out = first;
+
+        for (; element != end; ++element) {
+            if (out != first) {
+                std::char_traits<char_type>::copy(out, separator.data(), separator_length);
+                out += separator_length;
+            }
+
+            out = append_bounded(out, *element);
+        }
+
+        sink.commit_direct(out);
+    } else {
+        using writer_type = block_writer<SinkType>;
+
+        writer_type writer{ sink };
+
+        if (stride > writer_type::capacity) {
+            // A separator that doesn't fit in a block along with an element is written on its own.
+            for (bool is_first = true; element != end; ++element, is_first = false) {
+                if (!is_first) {
+                    writer.write(separator.data(), separator_length);
+                }
+
+                writer.reserve(element_length);
+
+                auto* const first = writer.position();
+                writer.advance(static_cast<std::size_t>(append_bounded(first, *element) - first));
+            }
+
+            writer.flush();
+            return;
+        }
+
+        const auto group_size = writer_type::capacity / stride;
+
+        std::size_t index = 0;
+        while (element != end) {
+            const auto group_end = std::min(size, index + group_size);
+            writer.reserve((group_end - index) * stride);
+
+            for (; index < group_end && element != end; ++index, ++element) {
+                if (index != 0) {
+                    writer.append(separator.data(), separator_length);
+                }
+
+                auto* const first = writer.position();
+                auto* const last = append_bounded(first, *element);
+
+                writer.advance(static_cast<std::size_t>(last - first));
+            }
+        }
+
+        writer.flush();
+    }
+}
+
+/**
+ * @brief The type of a member of a std::pair<...> or std::tuple<...>, without any references or
+ * qualifiers.
+ */
+template <std::size_t Index, typename TupleType>
+using member_type_t =
+    std::remove_cv_t<std::remove_reference_t<std::tuple_element_t<Index, TupleType>>>;
+
+/**
+ * @brief The type of the elements of a container, without any references or qualifiers.
+ */
+template <typename ContainerType>
+using range_element_t = std::decay_t<decltype(*std::begin(std::declval<const ContainerType&>()))>;
+
+template <typename Type> constexpr std::size_t field_count() noexcept;
+
+/**
+ * @returns The number of fields that the given members of a std::pair<...> or std::tuple<...> are
+ * flattened into.
+ */
+template <typename TupleType, std::size_t... Indices>
+constexpr std::size_t member_field_count(std::index_sequence<Indices...>) noexcept
+{
+    return (std::size_t{ 0 } + ... + field_count<member_type_t<Indices, TupleType>>());
+}
+
+/**
+ * @returns The number of fields that a value is flattened into: pairs and tuples contribute the
+ * fields of each of their members, while anything else is a single field.
+ */
+template <typename Type> constexpr std::size_t field_count() noexcept
+{
+    if constexpr (is_tuple_like_v<Type>) {
+        return member_field_count<Type>(std::make_index_sequence<std::tuple_size_v<Type>>{});
+    } else {
+        return 1;
+    }
+}
+
+/**
+ * @brief Runs of delimiters that are known at compile time, concatenated into a single buffer; run
+ * `index` spans `[bounds[index], bounds[index + 1])`.
+ */
+template <typename CharacterType, std::size_t Capacity, std::size_t RunCount> struct literal_runs
+{
+    CharacterType text[Capacity + 1] = {};
+    std::size_t bounds[RunCount + 1] = {};
+
+    constexpr std::basic_string_view<CharacterType> run(std::size_t index) const noexcept
+    {
+        return { text + bounds[index], bounds[index + 1] - bounds[index] };
+    }
+};
+
+/**
+ * @brief Builds `literal_runs<...>` at compile time, one run per field boundary.
+ */
+template <typename CharacterType, std::size_t Capacity, std::size_t RunCount>
+struct literal_run_builder
+{
+    using char_type = CharacterType;
+
+    literal_runs<CharacterType, Capacity, RunCount> runs;
+    std::size_t size = 0;
+    std::size_t run = 0;
+
+    constexpr void append(std::basic_string_view<CharacterType> literal) noexcept
+    {
+        for (const auto character : literal) {
+            runs.text[size++] = character;
+        }
+    }
+
+    constexpr void end_run() noexcept
+    {
+        runs.bounds[++run] = size;
+    }
+};
+
+template <typename Type, typename CharacterType> constexpr std::size_t shape_length() noexcept;
+
+template <typename TupleType, typename CharacterType, std::size_t... Indices>
+constexpr std::size_t member_shape_length(std::index_sequence<Indices...>) noexcept
+{
+    return (
+        std::size_t{ 0 } + ... + shape_length<member_type_t<Indices, TupleType>, CharacterType>());
+}
+
+/**
+ * @returns The combined length of the delimiters of a value, nested pairs and tuples included.
+ */
+template <typename Type, typename CharacterType> constexpr std::size_t shape_length() noexcept
+{
+    if constexpr (is_tuple_like_v<Type>) {
+        constexpr auto size = std::tuple_size_v<Type>;
+
+        return delimiters_length<Type, CharacterType>(size) +
+               member_shape_length<Type, CharacterType>(std::make_index_sequence<size>{});
+    } else {
+        return 0;
+    }
+}
+
+template <typename Type, typename BuilderType> constexpr void append_shape(BuilderType& builder);
+
+template <typename TupleType, typename BuilderType, std::size_t... Indices>
+constexpr void append_members(BuilderType& builder, std::index_sequence<Indices...>)
+{
+    [[maybe_unused]] constexpr const auto& values =
+        decorator::delimiters<TupleType, typename BuilderType::char_type>::values;
+
+    ((Indices == 0 ? void() : builder.append(values.separator),
+      append_shape<member_type_t<Indices, TupleType>>(builder)),
+     ...);
+}
+
+/**
+ * @brief Appends the delimiters of a value, ending a run wherever a field would be written.
+ */
+template <typename Type, typename BuilderType> constexpr void append_shape(BuilderType& builder)
+{
+    if constexpr (is_tuple_like_v<Type>) {
+        constexpr const auto& values =
+            decorator::delimiters<Type, typename BuilderType::char_type>::values;
+
+        builder.append(values.prefix);
+        append_members<Type>(builder, std::make_index_sequence<std::tuple_size_v<Type>>{});
+        builder.append(values.suffix);
+    } else {
+        builder.end_run();
+    }
+}
+
+/**
+ * @brief Fuses the delimiters of a container of pairs or tuples into one run per gap between two
+ * fields; see `fused_delimiters<...>`.
+ */
+template <typename ContainerType, typename ElementType, typename CharacterType>
+constexpr auto make_fused_runs() noexcept
+{
+    constexpr auto fields = field_count<ElementType>();
+    constexpr auto length = shape_length<ElementType, CharacterType>();
+    constexpr const auto& values = decorator::delimiters<ContainerType, CharacterType>::values;
+
+    literal_run_builder<CharacterType, length, fields + 1> element;
+    append_shape<ElementType>(element);
+    element.end_run();
+
+    const auto& shape = element.runs;
+
+    literal_run_builder<
+        CharacterType,
+        2 * length + values.prefix.size() + values.separator.size() + values.suffix.size(),
+        fields + 2>
+        container;
+
+    container.append(values.prefix);
+    container.append(shape.run(0));
+    container.end_run();
+
+    for (std::size_t field = 1; field < fields; ++field) {
+        container.append(shape.run(field));
+        container.end_run();
+    }
+
+    container.append(shape.run(fields));
+    container.append(values.separator);
+    container.append(shape.run(0));
+    container.end_run();
+
+    container.append(shape.run(fields));
+    container.append(values.suffix);
+    container.end_run();
+
+    return container.runs;
+}
+
+/**
+ * @brief The delimiters of a container of pairs or tuples, fused into one run per gap between two
+ * fields. With `N` fields per element, run `0` is the container's prefix along with whatever
+ * precedes the first field of an element, runs `1` to `N - 1` sit between the fields of an
+ * element, run `N` sits between two elements, and run `N + 1` closes the container. The elements
+ * of a `std::vector<std::pair<int, std::string>>`, for instance, are joined by `"), ("`.
+ */
+template <typename ContainerType, typename CharacterType> struct fused_delimiters
+{
+    using element_type = range_element_t<ContainerType>;
+
+    static constexpr std::size_t fields = field_count<element_type>();
+
+    static constexpr auto runs = make_fused_runs<ContainerType, element_type, CharacterType>();
+};
+
+/**
+ * @brief Base case for containers whose delimiters can't be fused.
+ */
+template <typename ContainerType, typename StreamType, typename FormatterType, typename = void>
+constexpr bool is_fusable_v = false;
+
+/**
+ * @brief Containers of pairs and tuples, printed to a sink by the `default_formatter<...>`, can
+ * have their delimiters fused.
+ */
+template <typename ContainerType, typename StreamType, typename FormatterType>
+constexpr bool is_fusable_v<
+    ContainerType, StreamType, FormatterType,
+    std::enable_if_t<
+        traits::is_sink_v<StreamType> &&
+        std::is_same_v<FormatterType, default_formatter<ContainerType, StreamType>>>> =
+    is_tuple_like_v<range_element_t<ContainerType>> &&
+    field_count<range_element_t<ContainerType>>() != 0;
+
+/**
+ * @returns True if the given delimiters are those of the container's `delimiters<...>`
+ * specialization, which are the ones that have been fused.
+ */
+template <typename ContainerType, typename CharacterType>
+bool has_static_delimiters(const decorator::wrapper<CharacterType>& delimiters) noexcept
+{
+    constexpr const auto& values = decorator::delimiters<ContainerType, CharacterType>::values;
+
+    return delimiters.prefix == values.prefix && delimiters.separator == values.separator &&
+           delimiters.suffix == values.suffix;
+}
+
+template <
+    std::size_t Field, typename SinkType, typename FormatterType, typename RunsType, typename Type>
+void write_fields(
+    SinkType& sink, const FormatterType& formatter, const RunsType& runs, const Type& value);
+
+template <
+    std::size_t Field, typename SinkType, typename FormatterType, typename RunsType,
+    typename TupleType, std::size_t... Indices>
+void write_member_fields(
+    SinkType& sink, const FormatterType& formatter, const RunsType& runs, const TupleType& tuple,
+    std::index_sequence<Indices...>)
+{
+    (write_fields<Field + member_field_count<TupleType>(std::make_index_sequence<Indices>{})>(
+         sink, formatter, runs, std::get<Indices>(tuple)),
+     ...);
+}
+
+/**
+ * @brief Writes the fields of a value, each preceded by its fused run of delimiters; the run that
+ * precedes the first field of an element is written by the caller.
+ */
+template <
+    std::size_t Field, typename SinkType, typename FormatterType, typename RunsType, typename Type>
+void write_fields(
+    SinkType& sink, const FormatterType& formatter, const RunsType& runs, const Type& value)
+{
+    if constexpr (is_tuple_like_v<Type>) {
+        write_member_fields<Field>(
+            sink, formatter, runs, value, std::make_index_sequence<std::tuple_size_v<Type>>{});
+    } else {
+        if constexpr (Field != 0) {
+            write_literal(sink, runs.run(Field));
+        }
+
+        formatter.print_element(sink, value);
+    }
+}
+
+/**
+ * @brief Prints a non-empty container of pairs or tuples, with a single literal write for each gap
+ * between two fields, rather than one for every prefix, separator, and suffix in that gap.
+ */
+template <typename SinkType, typename ContainerType, typename FormatterType>
+void write_fused(SinkType& sink, const ContainerType& container, const FormatterType& formatter)
+{
+    using fused_type = fused_delimiters<ContainerType, typename SinkType::char_type>;
+
+    constexpr auto fields = fused_type::fields;
+    const auto& runs = fused_type::runs;
+
+    write_literal(sink, runs.run(0));
+
+    bool is_first = true;
+    for (const auto& element : container) {
+        if (!is_first) {
+            write_literal(sink, runs.run(fields));
+        }
+
+        write_fields<0>(sink, formatter, runs, element);
+        is_first = false;
+    }
+
+    write_literal(sink, runs.run(fields + 1));
+}
+} // namespace detail
+
+/**
+ * @brief Default container formatter that will be used to print prefix, element, separator, and
+ * suffix strings to an output stream or sink.
+ */
+template <typename ContainerType, typename StreamType> struct default_formatter
+{
+    format_options options;
+
+    /**
+     * @brief The delimiters of the container itself; nested containers are printed with the
+     * delimiters of their own `delimiters<...>` specializations.
+     */
+    decorator::wrapper<typename StreamType::char_type> decorators =
+        decorator::delimiters<ContainerType, typename StreamType::char_type>::values;
+
+    void print_prefix(StreamType& stream) const noexcept
+    {
+        detail::write_literal(stream, decorators.prefix);
+    }
+
+    template <typename ElementType>
+    void print_element(StreamType& stream, const ElementType& element) const noexcept
+    {
+        if constexpr (traits::is_printable_as_container_v<ElementType>) {
+            to_stream(stream, element, default_formatter<ElementType, StreamType>{ options });
+        } else {
+            detail::write_element(stream, element, options);
+        }
+    }
+
+    void print_delimiter(StreamType& stream) const noexcept
+    {
+        detail::write_literal(stream, decorators.separator);
+    }
+
+    void print_suffix(StreamType& stream) const noexcept
+    {
+        detail::write_literal(stream, decorators.suffix);
+    }
+};
+
+/**
+ * @brief Helper function to determine if a container is empty.
+ */
+template <typename ContainerType> bool is_empty(const ContainerType& container) noexcept
+{
+    return container.empty();
+}
+
+/**
+ * @brief Helper function to test arrays for emptiness.
+ */
+template <typename ArrayType, std::size_t ArraySize>
+constexpr bool is_empty(const ArrayType (&)[ArraySize]) noexcept
+{
+    return ArraySize == 0;
+}
+
+/**
+ * @brief Prints the elements of a std::tuple<...>, separated by delimiters. A single fold over the
+ * element indices replaces one recursive instantiation per element, and the empty tuple needs no
+ * special treatment.
+ */
+template <typename StreamType, typename TupleType, typename FormatterType, std::size_t... Indices>
+void print_tuple_elements(
+    [[maybe_unused]] StreamType& stream, [[maybe_unused]] const TupleType& tuple,
+    [[maybe_unused]] const FormatterType& formatter, std::index_sequence<Indices...>)
+{
+    ((Indices == 0 ? void() : formatter.print_delimiter(stream),
+      formatter.print_element(stream, std::get<Indices>(tuple))),
+     ...);
+}
+
+/**
+ * @brief Overload to deal with std::tuple<...> objects.
+ */
+template <typename StreamType, typename FormatterType, typename... TupleArgs>
+StreamType& to_stream(
+    StreamType& stream, const std::tuple<TupleArgs...>& container, const FormatterType& formatter)
+{
+    const detail::narrow_text_scope<StreamType> scope{ stream };
+
+    formatter.print_prefix(stream);
+    print_tuple_elements(stream, container, formatter, std::index_sequence_for<TupleArgs...>{});
+    formatter.print_suffix(stream);
+
+    return stream;
+}
+
+/**
+ * @brief Overload to handle std::pair<...> objects.
+ */
+template <typename FirstType, typename SecondType, typename StreamType, typename FormatterType>
+StreamType& to_stream(
+    StreamType& stream, const std::pair<FirstType, SecondType>& container,
+    const FormatterType& formatter)
+{
+    const detail::narrow_text_scope<StreamType> scope{ stream };
+
+    formatter.print_prefix(stream);
+    formatter.print_element(stream, container.first);
+    formatter.print_delimiter(stream);
+    formatter.print_element(stream, container.second);
+    formatter.print_suffix(stream);
+
+    return stream;
+}
+
+/**
+ * @brief Overload to handle containers that support the notion of "emptiness,"
+ * and forward-iterability.
+ */
+template <typename ContainerType, typename StreamType, typename FormatterType>
+StreamType&
+to_stream(StreamType& stream, const ContainerType& container, const FormatterType& formatter)
+{
+    const detail::narrow_text_scope<StreamType> scope{ stream };
+
+    if constexpr (detail::is_bulk_formattable_v<ContainerType, StreamType, FormatterType>) {
+        using element_type = typename detail::contiguous_element<ContainerType>::type;
+
+        if (detail::has_plain_elements<element_type>(stream, formatter.options)) {
+            formatter.print_prefix(stream);
+            detail::write_contiguous_range(
+                stream, std::data(container), std::size(container),
+                formatter.decorators.separator, formatter.options);
+            formatter.print_suffix(stream);
+
+            return stream;
+        }
+    }
+
+    if constexpr (detail::is_bounded_formattable_v<ContainerType, StreamType, FormatterType>) {
+        const auto& options = formatter.options;
+
+        if (detail::has_plain_elements<int>(stream, options) &&
+            (options.parallel.thread_count == 1 ||
+             std::size(container) < options.parallel.threshold)) {
+            formatter.print_prefix(stream);
+            detail::write_bounded_range(stream, container, formatter.decorators.separator);
+            formatter.print_suffix(stream);
+
+            return stream;
+        }
+    }
+
+    if constexpr (
+        traits::is_sink_v<StreamType> &&
+        std::is_same_v<FormatterType, default_formatter<ContainerType, StreamType>>) {
+        if (formatter.options.parallel.thread_count != 1 &&
+            detail::print_in_parallel(
+                stream, container, formatter.options, formatter.decorators)) {
+            return stream;
+        }
+    }
+
+    if constexpr (detail::is_fusable_v<ContainerType, StreamType, FormatterType>) {
+        if (!is_empty(container) &&
+            detail::has_static_delimiters<ContainerType>(formatter.decorators)) {
+            detail::write_fused(stream, container, formatter);
+
+            return stream;
+        }
+    }
+
+    formatter.print_prefix(stream);
+
+    if (is_empty(container)) {
+        formatter.print_suffix(stream);
+
+        return stream;
+    }
+
+    auto begin = std::begin(container);
+    formatter.print_element(stream, *begin);
+
+    std::advance(begin, 1);
+
+    std::for_each(begin, std::end(container), [&stream, &formatter](const auto& element) {
+        formatter.print_delimiter(stream);
+        formatter.print_element(stream, element);
+    });
+
+    formatter.print_suffix(stream);
+
+    return stream;
+}
+
+namespace detail
+{
+/**
+ * @brief Lends out a thread-local string to format into. Should the thread-local string already be
+ * in use further up the stack, as it would be if an element's `operator<<` printed a container of
+ * its own, then a fresh string is lent out instead.
+ */
+template <typename CharacterType> class scratch_string
+{
+  public:
+    /**
+     * @brief The capacity above which the thread-local string is released after use, rather than
+     * kept around for the next container.
+     */
+    static constexpr std::size_t retained_capacity = 1024 * 1024;
+
+    scratch_string() noexcept : m_is_owner{ !is_in_use() }
+    {
+        is_in_use() = true;
+    }
+
+    ~scratch_string() noexcept
+    {
+        if (!m_is_owner) {
+            return;
+        }
+
+        auto& string = storage();
+        string.clear();
+
+        if (string.capacity() > retained_capacity) {
+            string.shrink_to_fit();
+        }
+
+        is_in_use() = false;
+    }
+
+    scratch_string(const scratch_string&) = delete;
+    scratch_string& operator=(const scratch_string&) = delete;
+
+    std::basic_string<CharacterType>& get() noexcept
+    {
+        return m_is_owner ? storage() : m_fallback;
+    }
+
+  private:
+    static std::basic_string<CharacterType>& storage() noexcept
+    {
+        thread_local std::basic_string<CharacterType> string;
+        return string;
+    }
+
+    static bool& is_in_use() noexcept
+    {
+        thread_local bool flag = false;
+        return flag;
+    }
+
+    bool m_is_owner;
+    std::basic_string<CharacterType> m_fallback;
+};
+
+/**
+ * @brief The type-erased printing engine, used for stream insertion when
+ * `CONTAINER_PRINTER_TYPE_ERASED` is defined.
+ *
+ * Rather than a full copy of `to_stream(...)` per combination of container, stream, and formatter,
+ * each container type only contributes a small function that writes its next element. A single
+ * traversal per sink type writes the delimiters and drives those functions.
+ *
+ * Containers that qualify for one of the dedicated kernels still take it, just as they would with
+ * `to_stream(...)`: contiguous containers of numbers are handed to `write_contiguous_range(...)`,
+ * which is shared by all containers with the same element type, and containers of bounded
+ * elements, large containers that the options ask to print in parallel, and containers of pairs
+ * and tuples are handed to the bounded, parallel, and fused kernels, respectively.
+ */
+namespace erased
+{
+/**
+ * @brief Writes the next element of a container, preceded by the separator if one is given, and
+ * advances the cursor.
+ *
+ * @returns False, without writing anything, once the cursor has reached the end of the container.
+ */
+template <typename SinkType>
+using element_writer = bool (*)(
+    void* cursor, SinkType& sink,
+    const std::basic_string_view<typename SinkType::char_type>* separator,
+    const format_options& options);
+
+/**
+ * @brief The traversal shared by all containers that are printed to the same type of sink; it is
+ * kept out of line, so that the callers don't each end up with a copy of their own.
+ */
+template <typename SinkType>
+CONTAINER_PRINTER_NOINLINE void traverse(
+    SinkType& sink, const decorator::wrapper<typename SinkType::char_type>& delimiters,
+    bool has_prefix, void* cursor, element_writer<SinkType> write_next,
+    const format_options& options)
+{
+    if (has_prefix) {
+        write_literal(sink, delimiters.prefix);
+    }
+
+    const std::basic_string_view<typename SinkType::char_type>* separator = nullptr;
+    while (write_next(cursor, sink, separator, options)) {
+        separator = &delimiters.separator;
+    }
+
+    write_literal(sink, delimiters.suffix);
+}
+
+template <typename SinkType, typename ContainerType>
+void write_container(
+    SinkType& sink, const ContainerType& container, const format_options& options,
+    const decorator::wrapper<typename SinkType::char_type>& delimiters, bool has_prefix = true);
+
+template <typename SinkType, typename Type>
+void write_value(SinkType& sink, const Type& value, const format_options& options)
+{
+    if constexpr (traits::is_printable_as_container_v<Type>) {
+        write_container(
+            sink, value, options,
+            decorator::delimiters<Type, typename SinkType::char_type>::values);
+    } else {
+        write_element(sink, value, options);
+    }
+}
+
+template <typename IteratorType> struct range_cursor
+{
+    IteratorType current;
+    IteratorType end;
+};
+
+template <typename SinkType, typename IteratorType>
+bool write_next_element(
+    void* cursor, SinkType& sink,
+    const std::basic_string_view<typename SinkType::char_type>* separator,
+    const format_options& options)
+{
+    auto& range = *static_cast<range_cursor<IteratorType>*>(cursor);
+    if (range.current == range.end) {
+        return false;
+    }
+
+    if (separator != nullptr) {
+        write_literal(sink, *separator);
+    }
+
+    write_value(sink, *range.current, options);
+    ++range.current;
+
+    return true;
+}
+
+template <typename TupleType> struct tuple_cursor
+{
+    const TupleType& tuple;
+    std::size_t index;
+};
+
+template <typename SinkType, typename TupleType, std::size_t... Indices>
+void write_member(
+    SinkType& sink, const TupleType& tuple, std::size_t index, const format_options& options,
+    std::index_sequence<Indices...>)
+{
+    ((Indices == index ? write_value(sink, std::get<Indices>(tuple), options) : void()), ...);
+}
+
+template <typename SinkType, typename TupleType>
+bool write_next_member(
+    void* cursor, SinkType& sink,
+    const std::basic_string_view<typename SinkType::char_type>* separator,
+    const format_options& options)
+{
+    constexpr auto size = std::tuple_size_v<TupleType>;
+
+    auto& members = *static_cast<tuple_cursor<TupleType>*>(cursor);
+    if (members.index == size) {
+        return false;
+    }
+
+    if (separator != nullptr) {
+        write_literal(sink, *separator);
+    }
+
+    write_member(sink, members.tuple, members.index, options, std::make_index_sequence<size>{});
+    ++members.index;
+
+    return true;
+}
+
+/**
+ * @brief Writes a container, with the given delimiters, including its prefix unless the caller
+ * has already written it.
+ */
+template <typename SinkType, typename ContainerType>
+void write_container(
+    SinkType& sink, const ContainerType& container, const format_options& options,
+    const decorator::wrapper<typename SinkType::char_type>& delimiters, bool has_prefix)
+{
+    if constexpr (is_tuple_like_v<ContainerType>) {
+        tuple_cursor<ContainerType> cursor{ container, 0 };
+        traverse(
+            sink, delimiters, has_prefix, &cursor, &write_next_member<SinkType, ContainerType>,
+            options);
+    } else {
+        if constexpr (traits::is_contiguous_container_v<ContainerType>) {
+            using element_type = typename contiguous_element<ContainerType>::type;
+
+            if constexpr (
+                is_numeric_integer_v<element_type> || std::is_floating_point_v<element_type>) {
+                if (has_plain_elements<element_type>(sink, options)) {
+                    if (has_prefix) {
+                        write_literal(sink, delimiters.prefix);
+                    }
+
+                    write_contiguous_range(
+                        sink, std::data(container), std::size(container), delimiters.separator,
+                        options);
+                    write_literal(sink, delimiters.suffix);
+
+                    return;
+                }
+            }
+        }
+
+        using formatter_type = default_formatter<ContainerType, SinkType>;
+
+        auto decorators = delimiters;
+        if (!has_prefix) {
+            decorators.prefix = {};
+        }
+
+        if constexpr (is_bounded_formattable_v<ContainerType, SinkType, formatter_type>) {
+            if (has_plain_elements<int>(sink, options) &&
+                (options.parallel.thread_count == 1 ||
+                 std::size(container) < options.parallel.threshold)) {
+                write_literal(sink, decorators.prefix);
+                write_bounded_range(sink, container, decorators.separator);
+                write_literal(sink, decorators.suffix);
+
+                return;
+            }
+        }
+
+        if (options.parallel.thread_count != 1 &&
+            print_in_parallel(sink, container, options, decorators)) {
+            return;
+        }
+
+        if constexpr (is_fusable_v<ContainerType, SinkType, formatter_type>) {
+            if (!is_empty(container) && has_static_delimiters<ContainerType>(decorators)) {
+                write_fused(sink, container, formatter_type{ options, decorators });
+
+                return;
+            }
+        }
+
+        using iterator_type = decltype(std::begin(container));
+
+        range_cursor<iterator_type> cursor{ std::begin(container), std::end(container) };
+        traverse(
+            sink, delimiters, has_prefix, &cursor, &write_next_element<SinkType, iterator_type>,
+            options);
+    }
+}
+} // namespace erased
+
+} // namespace detail
+
+/**
+ * @brief Pairs a container with the options that it should be printed with.
+ */
+template <typename ContainerType> struct options_wrapper
+{
+    const ContainerType& container;
+    format_options options;
+};
+
+/**
+ * @brief Helper function to print a container with non-default options, as in:
+ *
+ * `std::cout << container_printer::with_options(vector, { integer_format::stream });`
+ */
+template <typename ContainerType>
+options_wrapper<ContainerType>
+with_options(const ContainerType& container, const format_options& options) noexcept
+{
+    static_assert(
+        traits::is_printable_as_container_v<ContainerType>,
+        "Only printable containers can be paired with format options.");
+
+    return { container, options };
+}
+
+/**
+ * @brief Pairs a container with the delimiters, chosen at runtime, that it should be printed with.
+ */
+template <typename ContainerType, typename CharacterType> struct delimiters_wrapper
+{
+    const ContainerType& container;
+    decorator::wrapper<CharacterType> delimiters;
+    format_options options;
+};
+
+/**
+ * @brief Helper function to print a container with delimiters that are only known at runtime, as
+ * in:
+ *
+ * `std::cout << with_delimiters(vector, decorator::delimiter_set{ "{ ", "; ", " }" });`
+ *
+ * The delimiters apply to the container itself; nested containers keep their own.
+ */
+template <typename ContainerType, typename CharacterType>
+delimiters_wrapper<ContainerType, CharacterType> with_delimiters(
+    const ContainerType& container, const decorator::delimiter_set<CharacterType>& delimiters,
+    const format_options& options = {}) noexcept
+{
+    static_assert(
+        traits::is_printable_as_container_v<ContainerType>,
+        "Only printable containers can be paired with delimiters.");
+
+    return { container, delimiters.values(), options };
+}
+
+namespace detail
+{
+/**
+ * @brief Formats a container into the given string through a `string_sink<...>`.
+ */
+template <typename CharacterType, typename ContainerType, typename FormatterType>
+void format_to_string(
+    std::basic_string<CharacterType>& string, const ContainerType& container,
+    const FormatterType& formatter)
+{
+    static_assert(
+        traits::is_printable_as_container_v<ContainerType>,
+        "Only printable containers can be converted to a string.");
+
+    sinks::string_sink<CharacterType> sink{ string };
+    to_stream(sink, container, formatter);
+}
+
+/**
+ * @brief Moves a finished conversion into the thread-local string that `to_string_view(...)` hands
+ * out views into, and hands back the previous conversion in its place.
+ *
+ * The two strings are swapped rather than copied, so that both keep their capacity, subject to the
+ * same cap as `scratch_string`: a conversion that outgrew `retained_capacity` is shrunk to fit, and
+ * its buffer is released once the next conversion on the same thread has replaced it.
+ */
+template <typename CharacterType>
+std::basic_string_view<CharacterType> publish_view(std::basic_string<CharacterType>& string)
+{
+    thread_local std::basic_string<CharacterType> storage;
+    storage.swap(string);
+
+    if (storage.capacity() > scratch_string<CharacterType>::retained_capacity) {
+        storage.shrink_to_fit();
+    }
+
+    return storage;
+}
+} // namespace detail
+
+/**
+ * @brief Computes the exact length of a container's output, without producing any of it.
+ */
+template <typename CharacterType = char, typename ContainerType>
+std::size_t formatted_size(const ContainerType& container, const format_options& options = {})
+{
+    static_assert(
+        traits::is_printable_as_container_v<ContainerType>,
+        "Only printable containers can be measured.");
+
+    using sink_type = sinks::counting_sink<CharacterType>;
+
+    // Splitting the work over several threads would only mean producing the output after all.
+    auto serial_options = options;
+    serial_options.parallel.thread_count = 1;
+
+    sink_type sink;
+    to_stream(sink, container, default_formatter<ContainerType, sink_type>{ serial_options });
+
+    return sink.size();
+}
+
+/**
+ * @brief Computes the exact length of a container's output with a custom formatter, without
+ * producing any of it.
+ */
+template <typename CharacterType = char, typename ContainerType, typename FormatterType>
+std::size_t formatted_size(const ContainerType& container, const FormatterType& formatter)
+{
+    static_assert(
+        traits::is_printable_as_container_v<ContainerType>,
+        "Only printable containers can be measured.");
+
+    sinks::counting_sink<CharacterType> sink;
+    to_stream(sink, container, formatter);
+
+    return sink.size();
+}
+
+/**
+ * @brief Converts a container to a string, as in:
+ *
+ * `const auto text = container_printer::to_string(vector);`
+ *
+ * The output is measured with `formatted_size(...)` first, so that the string is allocated exactly
+ * once, at its final size.
+ */
+template <typename CharacterType = char, typename ContainerType>
+std::basic_string<CharacterType>
+to_string(const ContainerType& container, const format_options& options = {})
+{
+    using sink_type = sinks::string_sink<CharacterType>;
+
+    std::basic_string<CharacterType> string;
+    string.reserve(formatted_size<CharacterType>(container, options));
+
+    detail::format_to_string(
+        string, container, default_formatter<ContainerType, sink_type>{ options });
+
+    return string;
+}
+
+/**
+ * @brief Converts a container to a string with a custom formatter, as in:
+ *
+ * `const auto text = container_printer::to_string<wchar_t>(vector, custom_formatter{});`
+ */
+template <typename CharacterType = char, typename ContainerType, typename FormatterType>
+std::basic_string<CharacterType>
+to_string(const ContainerType& container, const FormatterType& formatter)
+{
+    std::basic_string<CharacterType> string;
+    string.reserve(formatted_size<CharacterType>(container, formatter));
+
+    detail::format_to_string(string, container, formatter);
+
+    return string;
+}
+
+/**
+ * @brief Converts a container to a string without allocating a string of its own.
+ *
+ * @returns A view into a thread-local buffer, which remains valid until the next call to
+ * `to_string_view(...)` on the same thread; that call overwrites, and may free, the buffer. Copy
+ * the view into a string of its own to keep it for longer.
+ */
+template <typename CharacterType = char, typename ContainerType>
+std::basic_string_view<CharacterType>
+to_string_view(const ContainerType& container, const format_options& options = {})
+{
+    using sink_type = sinks::string_sink<CharacterType>;
+
+    detail::scratch_string<CharacterType> scratch;
+    detail::format_to_string(
+        scratch.get(), container, default_formatter<ContainerType, sink_type>{ options });
+
+    return detail::publish_view(scratch.get());
+}
+
+/**
+ * @brief Converts a container to a string with a custom formatter, without allocating a string of
+ * its own.
+ *
+ * @returns A view into a thread-local buffer, which remains valid until the next call to
+ * `to_string_view(...)` on the same thread; that call overwrites, and may free, the buffer. Copy
+ * the view into a string of its own to keep it for longer.
+ */
+template <typename CharacterType = char, typename ContainerType, typename FormatterType>
+std::basic_string_view<CharacterType>
+to_string_view(const ContainerType& container, const FormatterType& formatter)
+{
+    detail::scratch_string<CharacterType> scratch;
+    detail::format_to_string(scratch.get(), container, formatter);
+
+    return detail::publish_view(scratch.get());
+}
+
+namespace detail
+{
+/**
+ * @brief Type trait to determine whether a value can be written to a sink with the default options
+ * without any heap allocation. Integers, floating-point values, characters, and strings of the
+ * sink's character type qualify, as do containers, pairs, and tuples of such values.
+ */
+template <typename Type, typename CharacterType, typename = void>
+struct is_allocation_free : public std::bool_constant<
+                                is_numeric_integer_v<Type> || std::is_floating_point_v<Type> ||
+                                std::is_same_v<Type, CharacterType> ||
+                                std::is_same_v<Type, const CharacterType*> ||
+                                std::is_same_v<Type, CharacterType*> ||
+                                std::is_convertible_v<
+                                    const Type&, std::basic_string_view<CharacterType>>>
+{
+};
+
+template <typename FirstType, typename SecondType, typename CharacterType>
+struct is_allocation_free<std::pair<FirstType, SecondType>, CharacterType>
+    : public std::bool_constant<
+          is_allocation_free<FirstType, CharacterType>::value &&
+          is_allocation_free<SecondType, CharacterType>::value>
+{
+};
+
+template <typename... Args, typename CharacterType>
+struct is_allocation_free<std::tuple<Args...>, CharacterType>
+    : public std::bool_constant<(is_allocation_free<Args, CharacterType>::value && ...)>
+{
+};
+
+template <typename ContainerType, typename CharacterType>
+struct is_allocation_free<
+    ContainerType, CharacterType,
+    std::enable_if_t<
+        traits::is_printable_as_container_v<ContainerType> &&
+        !is_tuple_like_v<ContainerType>>>
+    : public is_allocation_free<
+          std::decay_t<decltype(*std::begin(std::declval<const ContainerType&>()))>,
+          CharacterType>
+{
+};
+
+template <typename Type, typename CharacterType>
+constexpr bool is_allocation_free_v = is_allocation_free<Type, CharacterType>::value;
+} // namespace detail
+
+/**
+ * @brief The outcome of a call to `format_to(...)`.
+ */
+struct format_to_result
+{
+    /**
+     * @brief The number of characters that were written to the buffer.
+     */
+    std::size_t written;
+
+    /**
+     * @brief The number of characters that the complete output requires.
+     */
+    std::size_t size;
+
+    /**
+     * @brief True if the output didn't fit in the buffer, and was cut short.
+     */
+    bool truncated;
+};
+
+/**
+ * @brief Formats a container into a caller-provided buffer, without allocating any memory. The
+ * output is not null-terminated, and any output that doesn't fit is dropped.
+ *
+ * Containers whose elements could require an allocation, such as elements that are printed
+ * through their own `operator<<`, are rejected at compile time.
+ */
+template <typename CharacterType, typename ContainerType>
+format_to_result
+format_to(CharacterType* buffer, std::size_t capacity, const ContainerType& container) noexcept
+{
+    static_assert(
+        traits::is_printable_as_container_v<ContainerType>,
+        "Only printable containers can be formatted.");
+
+    static_assert(
+        detail::is_allocation_free_v<ContainerType, CharacterType>,
+        "The elements of this container can't be formatted without allocating memory.");
+
+    using sink_type = sinks::buffer_sink<CharacterType>;
+
+    sink_type sink{ buffer, capacity };
+    to_stream(sink, container, default_formatter<ContainerType, sink_type>{});
+
+    return { sink.written(), sink.size(), sink.truncated() };
+}
+
+/**
+ * @brief Formats a container into a caller-provided array, without allocating any memory.
+ */
+template <typename CharacterType, std::size_t Capacity, typename ContainerType>
+format_to_result
+format_to(CharacterType (&buffer)[Capacity], const ContainerType& container) noexcept
+{
+    return format_to(buffer, Capacity, container);
+}
+
+#ifdef __cpp_lib_span
+/**
+ * @brief Formats a container into a caller-provided span, without allocating any memory.
+ */
+template <typename CharacterType, std::size_t Extent, typename ContainerType>
+format_to_result
+format_to(std::span<CharacterType, Extent> buffer, const ContainerType& container) noexcept
+{
+    return format_to(buffer.data(), buffer.size(), container);
+}
+#endif
+
+/**
+ * @brief A fixed-size, null-terminated string that can be built at compile time.
+ */
+template <typename CharacterType, std::size_t Capacity> class static_string
+{
+  public:
+    using char_type = CharacterType;
+
+    constexpr void put(CharacterType character) noexcept
+    {
+        m_data[m_size++] = character;
+    }
+
+    constexpr void write(const CharacterType* data, std::size_t size) noexcept
+    {
+        for (std::size_t index = 0; index < size; ++index) {
+            m_data[m_size++] = data[index];
+        }
+    }
+
+    constexpr const CharacterType* c_str() const noexcept
+    {
+        return m_data;
+    }
+
+    constexpr std::size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+    constexpr std::basic_string_view<CharacterType> view() const noexcept
+    {
+        return { m_data, m_size };
+    }
+
+  private:
+    CharacterType m_data[Capacity + 1] = {};
+    std::size_t m_size = 0;
+};
+
+namespace detail
+{
+/**
+ * @brief Stand-in for a `static_string<...>` that only counts the characters written to it.
+ */
+template <typename CharacterType> struct static_counter
+{
+    using char_type = CharacterType;
+
+    constexpr void put(CharacterType /*character*/) noexcept
+    {
+        ++size;
+    }
+
+    constexpr void write(const CharacterType* /*data*/, std::size_t length) noexcept
+    {
+        size += length;
+    }
+
+    std::size_t size = 0;
+};
+
+/**
+ * @brief Prints a value at compile time. Integers, characters, and strings are supported, as are
+ * containers, pairs, and tuples of such values.
+ */
+template <typename WriterType, typename Type>
+constexpr void print_static(WriterType& writer, const Type& value) noexcept
+{
+    using char_type = typename WriterType::char_type;
+
+    if constexpr (is_numeric_integer_v<Type>) {
+        char digits[max_integer_length<Type>] = {};
+
+        auto* const last = digits + sizeof(digits);
+        for (const auto* digit = format_integer(last, value); digit != last; ++digit) {
+            writer.put(static_cast<char_type>(*digit));
+        }
+    } else if constexpr (
+        is_tuple_like_v<Type> || traits::is_printable_as_container_v<Type>) {
+        using delimiters_type = decorator::delimiters<Type, char_type>;
+
+        const auto write_literal = [&writer](std::basic_string_view<char_type> literal) {
+            writer.write(literal.data(), literal.size());
+        };
+
+        write_literal(delimiters_type::values.prefix);
+
+        if constexpr (is_tuple_like_v<Type>) {
+            std::apply(
+                [&](const auto&... members) {
+                    std::size_t index = 0;
+                    ((index++ == 0 ? void() : write_literal(delimiters_type::values.separator),
+                      print_static(writer, members)),
+                     ...);
+                },
+                value);
+        } else {
+            bool is_first = true;
+            for (const auto& element : value) {
+                if (!is_first) {
+                    write_literal(delimiters_type::values.separator);
+                }
+
+                print_static(writer, element);
+                is_first = false;
+            }
+        }
+
+        write_literal(delimiters_type::values.suffix);
+    } else if constexpr (std::is_same_v<Type, char_type>) {
+        writer.put(value);
+    } else if constexpr (std::is_convertible_v<const Type&, std::basic_string_view<char_type>>) {
+        const std::basic_string_view<char_type> view = value;
+        writer.write(view.data(), view.size());
+    } else if constexpr (std::is_same_v<Type, char>) {
+        // Narrow characters are widened, as `operator<<` would for the basic character set.
+        writer.put(static_cast<char_type>(value));
+    } else if constexpr (std::is_convertible_v<const Type&, std::string_view>) {
+        const std::string_view view = value;
+        for (const auto character : view) {
+            writer.put(static_cast<char_type>(character));
+        }
+    } else {
+        static_assert(
+            !std::is_same_v<Type, Type>,
+            "Only integers, characters, and strings can be printed at compile time.");
+    }
+}
+
+template <const auto& Container, typename CharacterType>
+constexpr std::size_t static_formatted_size() noexcept
+{
+    static_counter<CharacterType> counter;
+    print_static(counter, Container);
+
+    return counter.size;
+}
+
+template <const auto& Container, typename CharacterType>
+constexpr auto make_static_text() noexcept
+{
+    static_string<CharacterType, static_formatted_size<Container, CharacterType>()> string;
+    print_static(string, Container);
+
+    return string;
+}
+} // namespace detail
+
+/**
+ * @brief The output of a `constexpr` container, formatted at compile time, as in:
+ *
+ * `std::cout << container_printer::static_text<error_codes>;`
+ *
+ * The container must have static storage duration. Printing the result takes a single write of a
+ * static buffer.
+ */
+template <const auto& Container, typename CharacterType = char>
+inline constexpr auto static_text = detail::make_static_text<Container, CharacterType>();
+
+} // namespace container_printer
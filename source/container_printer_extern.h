@@ -0,0 +1,49 @@
+#pragma once
+
+/**
+ * @brief Companion header to `container_printer.h`, for use with the
+ * `container_printer_instantiations` library.
+ *
+ * The printing code for the container types that the library was configured with (see
+ * `CONTAINER_PRINTER_INSTANTIATED_TYPES` and `CONTAINER_PRINTER_INSTANTIATED_WIDE_TYPES` in
+ * `CMakeLists.txt`) is compiled once, into the library. Translation units that include this header,
+ * rather than `container_printer.h`, declare those instantiations `extern`, so that they neither
+ * compile nor emit a copy of their own. Other container types are instantiated as usual.
+ */
+
+#include "container_printer.h"
+
+/**
+ * @brief Declares, or with `CONTAINER_PRINTER_EXTERN` defined as empty, defines the instantiations
+ * that print the given container type to a `std::basic_ostream<CharacterType>`.
+ */
+#define CONTAINER_PRINTER_INSTANTIATE(CharacterType, ...)                                          \
+    CONTAINER_PRINTER_EXTERN template void container_printer::detail::print_to_ostream(            \
+        std::basic_ostream<CharacterType>&, const __VA_ARGS__&,                                    \
+        const container_printer::format_options&,                                                  \
+        const container_printer::decorator::wrapper<CharacterType>&);                              \
+    CONTAINER_PRINTER_EXTERN template struct container_printer::default_formatter<                 \
+        __VA_ARGS__, container_printer::sinks::ostream_sink<CharacterType>>;                       \
+    CONTAINER_PRINTER_EXTERN template container_printer::sinks::ostream_sink<CharacterType>&       \
+    container_printer::to_stream(                                                                  \
+        container_printer::sinks::ostream_sink<CharacterType>&, const __VA_ARGS__&,                \
+        const container_printer::default_formatter<                                                \
+            __VA_ARGS__, container_printer::sinks::ostream_sink<CharacterType>>&);
+
+#if !defined(CONTAINER_PRINTER_EXTERN)
+#define CONTAINER_PRINTER_EXTERN extern
+#endif
+
+#include "container_printer_instantiated_types.h"
+
+// Code that is compiled with a different engine, or a different stream output operator, than the
+// library would link against instantiations that don't match its own.
+#if defined(CONTAINER_PRINTER_TYPE_ERASED) != CONTAINER_PRINTER_INSTANTIATIONS_TYPE_ERASED
+#error "CONTAINER_PRINTER_TYPE_ERASED must match the container_printer_instantiations library."
+#endif
+
+#if defined(CONTAINER_PRINTER_USE_CONCEPTS) != CONTAINER_PRINTER_INSTANTIATIONS_USE_CONCEPTS
+#error "CONTAINER_PRINTER_USE_CONCEPTS must match the container_printer_instantiations library."
+#endif
+
+#undef CONTAINER_PRINTER_EXTERN
@@ -0,0 +1,262 @@
+#pragma once
+
+/**
+ * @brief Support for printing the containers that the container printer accepts with
+ * `std::format(...)` and `std::format_to(...)`, without going through a stream. The containers are
+ * delimited just as they are by `operator<<`.
+ *
+ * Containers are passed through `container_printer::fmt(...)`, and only the resulting wrapper has
+ * a `std::formatter` specialization; the standard library's own types, such as `std::vector<int>`,
+ * may not be given one, and have formatters of their own as of C++23. The support is provided
+ * wherever the standard library implements `std::format`, in which case
+ * `CONTAINER_PRINTER_HAS_FORMATTER` is defined.
+ */
+
+#include "container_printer_core.h"
+
+#if __has_include(<version>)
+#include <version>
+#endif
+
+#if defined(__cpp_lib_format)
+
+#define CONTAINER_PRINTER_HAS_FORMATTER
+
+#include <algorithm>
+#include <cstddef>
+#include <format>
+#include <iterator>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+CONTAINER_PRINTER_EXPORT namespace container_printer
+{
+/**
+ * @brief Refers to a container that is to be printed with `std::format(...)`.
+ */
+template <typename ContainerType> struct format_wrapper
+{
+    const ContainerType& container;
+};
+
+/**
+ * @brief Prepares a container to be printed with `std::format(...)`, as in:
+ *
+ *   std::format("{:#x}", container_printer::fmt(std::vector<int>{ 10, 11 })); // "[0xa, 0xb]"
+ *
+ * The format spec, if any, is parsed once per call, and is applied to every element; nested
+ * containers, pairs, and tuples pass it on to their own elements.
+ */
+template <typename ContainerType>
+format_wrapper<ContainerType> fmt(const ContainerType& container) noexcept
+{
+    static_assert(
+        traits::is_printable_as_container_v<ContainerType>,
+        "Only printable containers can be formatted.");
+
+    return { container };
+}
+
+namespace detail
+{
+/**
+ * @returns The format spec of the replacement field that is being parsed, up to, but excluding,
+ * its closing brace.
+ */
+template <typename CharacterType>
+constexpr std::basic_string_view<CharacterType>
+element_spec(const std::basic_format_parse_context<CharacterType>& context)
+{
+    const std::basic_string_view<CharacterType> remainder{ context.begin(), context.end() };
+    return remainder.substr(0, remainder.find(CharacterType('}')));
+}
+
+/**
+ * @brief Parses the format spec of a container once, on behalf of every element that the given
+ * formatter will format. Specs that refer to further arguments, such as `{:{}}`, aren't supported.
+ */
+template <typename FormatterType, typename CharacterType>
+constexpr void
+parse_element_spec(FormatterType& formatter, std::basic_string_view<CharacterType> spec)
+{
+    std::basic_format_parse_context<CharacterType> context{ spec };
+
+    if (formatter.parse(context) != context.end()) {
+        throw std::format_error{ "The format spec doesn't apply to the container's elements." };
+    }
+}
+
+/**
+ * @brief Writes a delimiter to the output iterator of a format context.
+ */
+template <typename OutputIteratorType, typename CharacterType>
+OutputIteratorType
+write_literal_to(OutputIteratorType out, std::basic_string_view<CharacterType> literal)
+{
+    return std::copy(literal.begin(), literal.end(), out);
+}
+
+template <typename ContainerType, typename CharacterType> class container_formatter;
+template <typename TupleType, typename CharacterType> class tuple_formatter;
+
+/**
+ * @brief The formatter for an element: one of the formatters below, for nested containers, pairs,
+ * and tuples, or the element's own `std::formatter` otherwise.
+ */
+template <typename Type, typename CharacterType>
+using value_formatter_t = std::conditional_t<
+    is_tuple_like_v<Type>, tuple_formatter<Type, CharacterType>,
+    std::conditional_t<
+        traits::is_printable_as_container_v<Type>, container_formatter<Type, CharacterType>,
+        std::formatter<Type, CharacterType>>>;
+
+/**
+ * @brief Formats the containers that the container printer accepts, other than std::pair<...> and
+ * std::tuple<...>.
+ */
+template <typename ContainerType, typename CharacterType> class container_formatter
+{
+  public:
+    constexpr void parse(std::basic_string_view<CharacterType> spec)
+    {
+        if constexpr (requires { m_element_formatter.parse(spec); }) {
+            m_element_formatter.parse(spec);
+        } else {
+            parse_element_spec(m_element_formatter, spec);
+        }
+    }
+
+    template <typename FormatContextType>
+    auto format(const ContainerType& container, FormatContextType& context) const
+    {
+        const auto& decorators = decorator::delimiters<ContainerType, CharacterType>::values;
+
+        auto out = write_literal_to(context.out(), decorators.prefix);
+
+        bool is_first = true;
+        for (const auto& element : container) {
+            if (!is_first) {
+                out = write_literal_to(out, decorators.separator);
+            }
+
+            context.advance_to(out);
+            out = m_element_formatter.format(element, context);
+            is_first = false;
+        }
+
+        return write_literal_to(out, decorators.suffix);
+    }
+
+  private:
+    using element_type =
+        std::remove_cvref_t<decltype(*std::begin(std::declval<const ContainerType&>()))>;
+
+    value_formatter_t<element_type, CharacterType> m_element_formatter;
+};
+
+/**
+ * @brief The formatters for the members of a std::pair<...> or std::tuple<...>.
+ */
+template <typename TupleType, typename CharacterType> struct member_formatters;
+
+template <typename FirstType, typename SecondType, typename CharacterType>
+struct member_formatters<std::pair<FirstType, SecondType>, CharacterType>
+{
+    using type = std::tuple<
+        value_formatter_t<std::remove_cvref_t<FirstType>, CharacterType>,
+        value_formatter_t<std::remove_cvref_t<SecondType>, CharacterType>>;
+};
+
+template <typename... Types, typename CharacterType>
+struct member_formatters<std::tuple<Types...>, CharacterType>
+{
+    using type = std::tuple<value_formatter_t<std::remove_cvref_t<Types>, CharacterType>...>;
+};
+
+/**
+ * @brief Formats std::pair<...> and std::tuple<...> objects. As with other containers, the format
+ * spec is parsed once per call, and is applied to every member.
+ */
+template <typename TupleType, typename CharacterType> class tuple_formatter
+{
+  public:
+    constexpr void parse(std::basic_string_view<CharacterType> spec)
+    {
+        std::apply(
+            [spec](auto&... formatters) {
+                (
+                    [spec](auto& formatter) {
+                        if constexpr (requires { formatter.parse(spec); }) {
+                            formatter.parse(spec);
+                        } else {
+                            parse_element_spec(formatter, spec);
+                        }
+                    }(formatters),
+                    ...);
+            },
+            m_member_formatters);
+    }
+
+    template <typename FormatContextType>
+    auto format(const TupleType& tuple, FormatContextType& context) const
+    {
+        const auto& decorators = decorator::delimiters<TupleType, CharacterType>::values;
+
+        auto out = write_literal_to(context.out(), decorators.prefix);
+        out = format_members(
+            tuple, context, out, std::make_index_sequence<std::tuple_size_v<TupleType>>{});
+
+        return write_literal_to(out, decorators.suffix);
+    }
+
+  private:
+    template <typename FormatContextType, typename OutputIteratorType, std::size_t... Indices>
+    OutputIteratorType format_members(
+        [[maybe_unused]] const TupleType& tuple, [[maybe_unused]] FormatContextType& context,
+        OutputIteratorType out, std::index_sequence<Indices...>) const
+    {
+        [[maybe_unused]] const auto& separator =
+            decorator::delimiters<TupleType, CharacterType>::values.separator;
+
+        ((out = Indices == 0 ? out : write_literal_to(out, separator), context.advance_to(out),
+          out = std::get<Indices>(m_member_formatters).format(std::get<Indices>(tuple), context)),
+         ...);
+
+        return out;
+    }
+
+    typename member_formatters<TupleType, CharacterType>::type m_member_formatters;
+};
+} // namespace detail
+} // namespace container_printer
+
+/**
+ * @brief Formats a container that has been passed through `container_printer::fmt(...)`.
+ */
+template <typename ContainerType, typename CharacterType>
+struct std::formatter<container_printer::format_wrapper<ContainerType>, CharacterType>
+{
+  public:
+    constexpr auto parse(std::basic_format_parse_context<CharacterType>& context)
+    {
+        const auto spec = container_printer::detail::element_spec(context);
+        m_formatter.parse(spec);
+
+        return context.begin() + static_cast<std::ptrdiff_t>(spec.size());
+    }
+
+    template <typename FormatContextType>
+    auto format(
+        const container_printer::format_wrapper<ContainerType>& wrapper,
+        FormatContextType& context) const
+    {
+        return m_formatter.format(wrapper.container, context);
+    }
+
+  private:
+    container_printer::detail::value_formatter_t<ContainerType, CharacterType> m_formatter;
+};
+
+#endif
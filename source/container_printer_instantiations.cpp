@@ -0,0 +1,9 @@
+/**
+ * Explicit instantiations of the printing code for the container types that the
+ * `container_printer_instantiations` library was configured with.
+ */
+
+#include "container_printer_extern.h"
+
+#define CONTAINER_PRINTER_EXTERN
+#include "container_printer_instantiated_types.h"
@@ -0,0 +1,124 @@
+#define CATCH_CONFIG_MAIN // This tells Catch to provide a main() - only do this in one cpp file
+#include <catch2/catch.hpp>
+
+// These tests replace the global `operator new` and `operator delete` in order to count heap
+// allocations, and so are built into an executable of their own, apart from the unit tests.
+
+#include "container_printer.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+/**
+ * @brief The number of heap allocations made on the current thread, as counted by the replacement
+ * `operator new` and `operator new[]` below.
+ */
+thread_local std::size_t allocation_count = 0;
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    ++allocation_count;
+
+    if (auto* const memory = std::malloc(size == 0 ? 1 : size)) {
+        return memory;
+    }
+
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t /*size*/) noexcept
+{
+    std::free(memory);
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    operator delete(memory);
+}
+
+void operator delete[](void* memory, std::size_t /*size*/) noexcept
+{
+    operator delete(memory);
+}
+
+TEST_CASE("Counting Allocations")
+{
+    SECTION("Array allocations are counted as well.")
+    {
+        const auto allocations_before = allocation_count;
+        delete[] new int[4];
+        const auto allocations_after = allocation_count;
+
+        REQUIRE(allocations_after - allocations_before == 1);
+    }
+}
+
+TEST_CASE("Formatting into Fixed Buffers")
+{
+    SECTION("Formatting a nested container into a buffer doesn't allocate.")
+    {
+        const std::map<int, std::vector<double>> map{ { 1, { 0.5, 2.0 } }, { 2, {} } };
+        const std::tuple<int, const char*, std::string> tuple{ 1, "two", "three" };
+
+        char buffer[64];
+
+        const auto allocations_before = allocation_count;
+        const auto map_result = container_printer::format_to(buffer, map);
+        const auto tuple_result = container_printer::format_to(buffer, tuple);
+        const auto allocations_after = allocation_count;
+
+        REQUIRE(allocations_after == allocations_before);
+        REQUIRE(map_result.written == map_result.size);
+        REQUIRE(std::string_view{ buffer, tuple_result.written } == "<1, two, three>");
+    }
+
+    SECTION("Truncating a large contiguous container doesn't allocate.")
+    {
+        const std::vector<std::int64_t> vector(10'000, -1234567890123);
+
+        wchar_t buffer[32];
+
+        const auto allocations_before = allocation_count;
+        const auto result = container_printer::format_to(buffer, vector);
+        const auto allocations_after = allocation_count;
+
+        REQUIRE(allocations_after == allocations_before);
+        REQUIRE(result.truncated == true);
+    }
+}
+
+TEST_CASE("Converting to Strings")
+{
+    SECTION("Converting a large container to a string allocates only once.")
+    {
+        std::vector<int> vector(100'000);
+        std::iota(std::begin(vector), std::end(vector), -50'000);
+
+        const auto allocations_before = allocation_count;
+        const auto string = container_printer::to_string(vector);
+        const auto allocations_after = allocation_count;
+
+        REQUIRE(allocations_after - allocations_before == 1);
+        REQUIRE(string.size() == container_printer::formatted_size(vector));
+    }
+}
@@ -1,13 +1,31 @@
 #define CATCH_CONFIG_MAIN // This tells Catch to provide a main() - only do this in one cpp file
 #include <catch2/catch.hpp>
 
+#if defined(CONTAINER_PRINTER_USE_INSTANTIATIONS)
+#include "container_printer_extern.h"
+#else
 #include "container_printer.h"
+#endif
+
+#include "container_printer_format.h"
+
+#if defined(CONTAINER_PRINTER_USE_CONCEPTS)
+using namespace container_printer::operators;
+#endif
 
 #include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <list>
+#include <locale>
+#include <iomanip>
 #include <map>
+#include <mutex>
+#include <numeric>
+#include <random>
 #include <set>
+#include <thread>
 #include <vector>
 
 namespace
@@ -110,6 +128,24 @@ TEST_CASE("Traits")
         REQUIRE(
             container_printer::traits::is_printable_as_container_v<vector_wrapper<int>> == true);
     }
+
+#if defined(CONTAINER_PRINTER_USE_CONCEPTS)
+    SECTION("Constrain the stream output operator with concepts.")
+    {
+        using container_printer::traits::output_stream;
+        using container_printer::traits::printable_container;
+
+        STATIC_REQUIRE(printable_container<std::vector<int>>);
+        STATIC_REQUIRE(printable_container<int[10]>);
+        STATIC_REQUIRE(printable_container<std::tuple<int, double>>);
+        STATIC_REQUIRE_FALSE(printable_container<int>);
+        STATIC_REQUIRE_FALSE(printable_container<std::string>);
+
+        STATIC_REQUIRE(output_stream<std::ostringstream>);
+        STATIC_REQUIRE(output_stream<container_printer::sinks::string_sink<char>>);
+        STATIC_REQUIRE_FALSE(output_stream<std::string*>);
+    }
+#endif
 }
 
 TEST_CASE("Delimiter Validation")
@@ -467,3 +503,1742 @@ TEST_CASE("Printing with Custom Formatters")
         REQUIRE(wide_buffer.str() == L"$$ 1 | 2 $$");
     }
 }
+
+namespace
+{
+/**
+ * @brief A character classification facet that widens narrow characters as Latin-1, as a single
+ * byte locale would.
+ */
+class latin1_ctype : public std::ctype<wchar_t>
+{
+  protected:
+    wchar_t do_widen(char character) const override
+    {
+        return static_cast<wchar_t>(static_cast<unsigned char>(character));
+    }
+
+    const char* do_widen(const char* first, const char* last, wchar_t* output) const override
+    {
+        for (; first != last; ++first, ++output) {
+            *output = do_widen(*first);
+        }
+
+        return last;
+    }
+};
+
+/**
+ * @brief Text whose `operator<<` prints it through a stream of its own, under a Latin-1 locale.
+ */
+struct latin1_text
+{
+    std::vector<std::string> values;
+};
+
+std::wostream& operator<<(std::wostream& stream, const latin1_text& text)
+{
+    std::wostringstream inner;
+    inner.imbue(std::locale{ std::locale::classic(), new latin1_ctype });
+    container_printer::to_stream(
+        inner, text.values,
+        container_printer::default_formatter<std::vector<std::string>, std::wostringstream>{});
+
+    return stream << inner.str();
+}
+} // namespace
+
+TEST_CASE("Printing Narrow Strings to Wide Streams")
+{
+    SECTION("Printing a std::map<std::string, int> decodes the keys from UTF-8.")
+    {
+        const std::map<std::string, int> map{ { "alpha", 1 }, { "b\xC3\xA9ta", 2 } };
+
+        std::wostringstream stream;
+        stream << map;
+
+        REQUIRE(stream.str() == L"[(alpha, 1), (b\u00E9ta, 2)]");
+        REQUIRE(container_printer::to_string<wchar_t>(map) == stream.str());
+    }
+
+    SECTION("Characters outside of the basic multilingual plane.")
+    {
+        const std::vector<std::string> vector{ "\xF0\x9F\x98\x80", "\xE2\x82\xAC" };
+
+        std::wostringstream stream;
+        stream << vector;
+
+        if constexpr (sizeof(wchar_t) == 2) {
+            REQUIRE(stream.str() == L"[\xD83D\xDE00, \x20AC]");
+        } else {
+            REQUIRE(stream.str() == L"[\x1F600, \x20AC]");
+        }
+    }
+
+    SECTION("Malformed sequences are replaced, one replacement per maximal invalid subpart.")
+    {
+        const std::vector<std::string> vector{ "a\xC3(\xE0\x80z\xF4\x90\x80\x80.\xE2\x82" };
+
+        std::wostringstream stream;
+        stream << vector;
+
+        REQUIRE(stream.str() == L"[a\xFFFD(\xFFFD\xFFFDz\xFFFD\xFFFD\xFFFD\xFFFD.\xFFFD]");
+    }
+
+    SECTION("Long strings, with multi-byte sequences around every block boundary.")
+    {
+        std::string text;
+        std::wstring expected;
+
+        for (int index = 0; index < 300; ++index) {
+            text += std::string(static_cast<std::size_t>(index % 19), 'x') + "\xC3\xA9";
+            expected += std::wstring(static_cast<std::size_t>(index % 19), L'x') + L"\u00E9";
+        }
+
+        std::wostringstream stream;
+        stream << std::vector<std::string>{ text, text };
+
+        REQUIRE(stream.str() == L"[" + expected + L", " + expected + L"]");
+    }
+
+    SECTION("A lone narrow character is widened by the stream, as it always was.")
+    {
+        std::wostringstream expected;
+        expected << L'[' << '\xE9' << L", " << 'a' << L']';
+
+        std::wostringstream stream;
+        stream << std::vector<char>{ '\xE9', 'a' };
+
+        REQUIRE(stream.str() == expected.str());
+    }
+
+    SECTION("Under a locale that isn't UTF-8, narrow characters are widened by the locale.")
+    {
+        const std::locale latin1{ std::locale::classic(), new latin1_ctype };
+
+        const std::vector<std::string> vector{ "caf\xE9" };
+        const std::list<const char*> list{ "na\xEFve" };
+
+        std::wostringstream stream;
+        stream.imbue(latin1);
+        stream << vector << list << std::vector<char>{ '\xE9' };
+
+        REQUIRE(stream.str() == L"[caf\u00E9][na\u00EFve][\u00E9]");
+
+        std::wostringstream unbuffered;
+        unbuffered.imbue(latin1);
+        container_printer::to_stream(
+            unbuffered, vector,
+            container_printer::default_formatter<decltype(vector), std::wostringstream>{});
+
+        REQUIRE(unbuffered.str() == L"[caf\u00E9]");
+    }
+
+    SECTION("Printing through a formatter to a wide stream, rather than to a sink.")
+    {
+        const std::list<std::string> list{ "na\xC3\xAFve", "caf\xC3\xA9" };
+
+        std::wostringstream stream;
+        container_printer::to_stream(
+            stream, list,
+            container_printer::default_formatter<decltype(list), std::wostringstream>{});
+
+        REQUIRE(stream.str() == L"[na\u00EFve, caf\u00E9]");
+    }
+
+    SECTION("A print to another stream, nested within the first, uses its own locale.")
+    {
+        using tuple_type = std::tuple<std::string, latin1_text, std::string>;
+        const tuple_type tuple{ "caf\xC3\xA9", { { "caf\xE9" } }, "na\xC3\xAFve" };
+
+        std::wostringstream stream;
+        container_printer::to_stream(
+            stream, tuple, container_printer::default_formatter<tuple_type, std::wostringstream>{});
+
+        REQUIRE(stream.str() == L"<caf\u00E9, [caf\u00E9], na\u00EFve>");
+    }
+}
+
+TEST_CASE("Printing to UTF-8, UTF-16, and UTF-32 Sinks")
+{
+    const std::map<std::string, std::vector<int>> map{ { "b\xC3\xA9ta", { 1, 2 } },
+                                                       { "\xF0\x9F\x98\x80", {} } };
+
+    SECTION("The delimiters are generated at compile time for every character type.")
+    {
+        using container_printer::decorator::delimiters;
+
+        STATIC_REQUIRE(delimiters<std::vector<int>, char16_t>::values.prefix == u"[");
+        STATIC_REQUIRE(delimiters<std::set<int>, char32_t>::values.suffix == U"}");
+        STATIC_REQUIRE(delimiters<std::pair<int, int>, char16_t>::values.separator == u", ");
+        STATIC_REQUIRE(delimiters<std::tuple<int>, char32_t>::values.prefix == U"<");
+        STATIC_REQUIRE(delimiters<std::multiset<int>, wchar_t>::values.prefix == L"{");
+    }
+
+    SECTION("Converting a nested container to UTF-16 and to UTF-32.")
+    {
+        REQUIRE(
+            container_printer::to_string<char16_t>(map) ==
+            u"[(b\u00E9ta, [1, 2]), (\U0001F600, [])]");
+        REQUIRE(
+            container_printer::to_string<char32_t>(map) ==
+            U"[(b\u00E9ta, [1, 2]), (\U0001F600, [])]");
+        REQUIRE(
+            container_printer::formatted_size<char16_t>(map) ==
+            container_printer::to_string<char16_t>(map).size());
+    }
+
+    SECTION("Printing strings, characters, and numbers through the bulk and bounded paths.")
+    {
+        std::u16string output;
+        container_printer::sinks::string_sink<char16_t> sink{ output };
+        sink << std::set<std::u16string>{ u"x", u"y" } << std::vector<char>{ 'a', 'b' }
+             << std::vector<std::pair<int, double>>{ { 1, 0.5 } };
+
+        REQUIRE(output == u"{x, y}[a, b][(1, 0.5)]");
+    }
+
+    SECTION("Printing to a UTF-32 buffer.")
+    {
+        std::array<char32_t, 8> buffer;
+        container_printer::sinks::buffer_sink<char32_t> sink{ buffer.data(), buffer.size() };
+        sink << std::list<int>{ 1, 2, 3, 4 };
+
+        REQUIRE(std::u32string_view{ buffer.data(), sink.written() } == U"[1, 2, 3");
+        REQUIRE(sink.truncated());
+    }
+
+#if defined(__cpp_char8_t)
+    SECTION("Narrow strings are copied to UTF-8 sinks unchanged.")
+    {
+        REQUIRE(
+            container_printer::to_string<char8_t>(map) ==
+            u8"[(b\u00E9ta, [1, 2]), (\U0001F600, [])]");
+    }
+#endif
+}
+
+TEST_CASE("Printing with Runtime Delimiters")
+{
+    const container_printer::decorator::delimiter_set delimiters{ "{ ", "; ", " }" };
+
+    SECTION("Printing a std::vector<...> of integers, which takes the bulk path.")
+    {
+        std::stringstream stream;
+        stream << container_printer::with_delimiters(std::vector<int>{ 1, 2, 3 }, delimiters);
+
+        REQUIRE(stream.str() == "{ 1; 2; 3 }");
+    }
+
+    SECTION("Printing a std::vector<...> of bounded pairs, which takes the bounded path.")
+    {
+        const std::vector<std::pair<int, int>> vector{ { 1, 2 }, { 3, 4 } };
+
+        std::stringstream stream;
+        stream << container_printer::with_delimiters(vector, delimiters);
+
+        REQUIRE(stream.str() == "{ (1, 2); (3, 4) }");
+    }
+
+    SECTION("Nested containers keep their own delimiters.")
+    {
+        const std::map<std::string, std::vector<int>> map{ { "a", { 1, 2 } }, { "b", {} } };
+
+        std::stringstream stream;
+        stream << container_printer::with_delimiters(map, delimiters);
+
+        REQUIRE(stream.str() == "{ (a, [1, 2]); (b, []) }");
+    }
+
+    SECTION("Printing in parallel, atomically, and to a wide stream.")
+    {
+        std::vector<std::vector<int>> vector(64, std::vector<int>{ 1, 2 });
+
+        container_printer::format_options options;
+        options.parallel.thread_count = 4;
+        options.parallel.threshold = 1;
+        options.parallel.chunk_size = 8;
+        options.atomic_write = true;
+
+        std::string expected = "{ ";
+        for (std::size_t index = 0; index < vector.size(); ++index) {
+            expected += index == 0 ? "[1, 2]" : "; [1, 2]";
+        }
+
+        expected += " }";
+
+        std::stringstream stream;
+        stream << container_printer::with_delimiters(vector, delimiters, options);
+
+        REQUIRE(stream.str() == expected);
+
+        const container_printer::decorator::delimiter_set wide_delimiters{ L"<", L"|", L">" };
+
+        std::wstringstream wide_stream;
+        wide_stream << container_printer::with_delimiters(std::list<int>{ 1, 2 }, wide_delimiters);
+
+        REQUIRE(wide_stream.str() == L"<1|2>");
+    }
+
+    SECTION("Delimiters are validated once, on construction.")
+    {
+        const std::string long_separator(65, ',');
+
+        REQUIRE_THROWS_AS(
+            container_printer::decorator::delimiter_set<char>("[", long_separator, "]"),
+            std::length_error);
+    }
+}
+
+namespace
+{
+/**
+ * @brief A string buffer that counts how often it is synchronized, and that accepts at most a
+ * fixed number of characters, after which every write fails.
+ */
+class limited_buffer : public std::stringbuf
+{
+  public:
+    explicit limited_buffer(std::size_t capacity = static_cast<std::size_t>(-1))
+        : m_capacity{ capacity }
+    {
+    }
+
+    std::size_t sync_count() const
+    {
+        return m_sync_count;
+    }
+
+    std::size_t write_count() const
+    {
+        return m_write_count;
+    }
+
+  protected:
+    std::streamsize xsputn(const char* data, std::streamsize size) override
+    {
+        ++m_write_count;
+
+        const auto available = m_capacity - std::min(m_capacity, str().size());
+        const auto accepted = std::min(static_cast<std::size_t>(size), available);
+
+        return std::stringbuf::xsputn(data, static_cast<std::streamsize>(accepted));
+    }
+
+    int_type overflow(int_type character) override
+    {
+        if (str().size() >= m_capacity) {
+            return traits_type::eof();
+        }
+
+        return std::stringbuf::overflow(character);
+    }
+
+    int sync() override
+    {
+        ++m_sync_count;
+        return std::stringbuf::sync();
+    }
+
+  private:
+    std::size_t m_capacity;
+    std::size_t m_sync_count = 0;
+    std::size_t m_write_count = 0;
+};
+
+/**
+ * @brief Prints a container through a formatter for `std::ostringstream` itself, which bypasses the
+ * sinks and the kernels behind them, as a reference for the output that they have to match.
+ */
+template <typename ContainerType>
+std::string print_unbuffered(const ContainerType& container, std::streamsize precision = 6)
+{
+    std::ostringstream stream;
+    stream.precision(precision);
+    container_printer::to_stream(
+        stream, container,
+        container_printer::default_formatter<ContainerType, std::ostringstream>{});
+
+    return stream.str();
+}
+} // namespace
+
+TEST_CASE("Printing to Sinks")
+{
+    SECTION("Printing a populated std::vector<...> to a std::string.")
+    {
+        const std::vector<int> vector{ 1, 2, 3, 4 };
+
+        std::string output;
+        container_printer::sinks::string_sink<char> sink{ output };
+        sink << vector;
+
+        REQUIRE(output == "[1, 2, 3, 4]");
+    }
+
+    SECTION("Printing a nested container to a wide std::wstring.")
+    {
+        const auto map = std::map<int, std::wstring>{ { 1, L"Template" }, { 2, L"Meta" } };
+
+        std::wstring output;
+        container_printer::sinks::string_sink<wchar_t> sink{ output };
+        sink << map;
+
+        REQUIRE(output == L"[(1, Template), (2, Meta)]");
+    }
+
+    SECTION("Printing to a contiguous buffer that is large enough.")
+    {
+        const std::set<int> set{ 1, 2, 3 };
+
+        char buffer[16] = {};
+        container_printer::sinks::buffer_sink<char> sink{ buffer, sizeof(buffer) };
+        sink << set;
+
+        REQUIRE(sink.truncated() == false);
+        REQUIRE(std::string_view{ buffer, sink.written() } == "{1, 2, 3}");
+    }
+
+    SECTION("Printing to a contiguous buffer that is too small.")
+    {
+        const std::vector<int> vector{ 10, 20, 30 };
+
+        char buffer[5] = {};
+        container_printer::sinks::buffer_sink<char> sink{ buffer, sizeof(buffer) };
+        sink << vector;
+
+        REQUIRE(sink.truncated() == true);
+        REQUIRE(sink.size() == std::string_view{ "[10, 20, 30]" }.size());
+        REQUIRE(std::string_view{ buffer, sink.written() } == "[10, ");
+    }
+
+    SECTION("Printing through an output iterator.")
+    {
+        const auto tuple = std::make_tuple(1, "two", 3.5);
+
+        std::vector<char> output;
+        auto sink = container_printer::sinks::make_iterator_sink<char>(std::back_inserter(output));
+        sink << tuple;
+
+        REQUIRE(std::string_view{ output.data(), output.size() } == "<1, two, 3.5>");
+    }
+
+    SECTION("Printing through a sink with a custom formatter.")
+    {
+        const auto container = std::vector<int>{ 1, 2, 3, 4 };
+
+        std::wstring output;
+        container_printer::sinks::string_sink<wchar_t> sink{ output };
+        container_printer::to_stream(sink, container, custom_formatter{});
+
+        REQUIRE(output == L"$$ 1 | 2 | 3 | 4 $$");
+    }
+
+    SECTION("Printing a large container produces the same output as the unbuffered path.")
+    {
+        std::vector<int> vector(10'000);
+        std::iota(std::begin(vector), std::end(vector), -5'000);
+
+        std::ostringstream buffered;
+        buffered << vector;
+
+        REQUIRE(buffered.str() == print_unbuffered(vector));
+    }
+
+    SECTION("Stream state continues to apply to the prefix and the elements.")
+    {
+        const std::vector<int> vector{ 10, 11 };
+
+        std::ostringstream stream;
+        stream << std::hex << std::setw(3) << vector;
+
+        REQUIRE(stream.str() == "  [a, b]");
+    }
+}
+
+TEST_CASE("Writing to the Stream Buffer")
+{
+    const std::vector<int> vector{ 1, 2, 3 };
+
+    SECTION("The field width and fill apply to the prefix, and are then reset.")
+    {
+        std::ostringstream stream;
+        stream << std::setfill('*') << std::setw(4) << vector << std::setw(4) << 5;
+
+        REQUIRE(stream.str() == "***[1, 2, 3]***5");
+
+        std::ostringstream left;
+        left << std::left << std::setw(3) << vector << '|';
+
+        REQUIRE(left.str() == "[  1, 2, 3]|");
+    }
+
+    SECTION("The field width applies to the prefix when printing atomically, and to wide streams.")
+    {
+        container_printer::format_options options;
+        options.atomic_write = true;
+
+        limited_buffer buffer;
+        std::ostream stream{ &buffer };
+        stream << std::setw(3) << container_printer::with_options(vector, options);
+
+        REQUIRE(buffer.str() == "  [1, 2, 3]");
+        REQUIRE(buffer.write_count() == 1);
+
+        std::wostringstream wide;
+        wide << std::setfill(L'.') << std::left << std::setw(2) << vector;
+
+        REQUIRE(wide.str() == L"[.1, 2, 3]");
+    }
+
+    SECTION("The tied stream is flushed once, and so is a stream with unitbuf set.")
+    {
+        limited_buffer tied_buffer;
+        std::ostream tied{ &tied_buffer };
+
+        limited_buffer buffer;
+        std::ostream stream{ &buffer };
+        stream.tie(&tied);
+        stream << std::unitbuf << std::vector<std::vector<int>>{ { 1, 2 }, { 3 } };
+
+        REQUIRE(buffer.str() == "[[1, 2], [3]]");
+        REQUIRE(buffer.sync_count() == 1);
+        REQUIRE(tied_buffer.sync_count() == 1);
+    }
+
+    SECTION("Nothing is written to a stream that isn't good.")
+    {
+        std::ostringstream stream;
+        stream.setstate(std::ios_base::failbit);
+        stream << vector;
+
+        REQUIRE(stream.str().empty());
+    }
+
+    SECTION("A failed write sets badbit, and nothing more is written.")
+    {
+        std::vector<int> large(10'000);
+        std::iota(std::begin(large), std::end(large), 0);
+
+        limited_buffer buffer{ 0 };
+        std::ostream stream{ &buffer };
+        stream << large;
+
+        REQUIRE(stream.bad());
+        REQUIRE(buffer.str().empty());
+        REQUIRE(buffer.write_count() == 1);
+    }
+}
+
+TEST_CASE("Printing of Integers")
+{
+    SECTION("Printing the extremes of each integer width.")
+    {
+        const auto tuple = std::make_tuple(
+            std::numeric_limits<std::int8_t>::min(), std::numeric_limits<std::int16_t>::min(),
+            std::numeric_limits<std::int32_t>::min(), std::numeric_limits<std::int64_t>::min(),
+            std::numeric_limits<std::uint16_t>::max(), std::numeric_limits<std::uint32_t>::max(),
+            std::numeric_limits<std::uint64_t>::max());
+
+        std::ostringstream expected;
+        expected << "<" << std::get<0>(tuple) << ", " << std::get<1>(tuple) << ", "
+                 << std::get<2>(tuple) << ", " << std::get<3>(tuple) << ", " << std::get<4>(tuple)
+                 << ", " << std::get<5>(tuple) << ", " << std::get<6>(tuple) << ">";
+
+        std::ostringstream stream;
+        stream << tuple;
+
+        REQUIRE(stream.str() == expected.str());
+    }
+
+    SECTION("Printing every power of ten, and its neighbours, in a std::vector<std::int64_t>.")
+    {
+        std::vector<std::int64_t> vector;
+        for (std::int64_t value = 1; value < std::numeric_limits<std::int64_t>::max() / 10;
+             value *= 10) {
+            vector.insert(std::end(vector), { value - 1, value, value + 1, -value });
+        }
+
+        std::string expected = "[";
+        for (const auto value : vector) {
+            expected += std::to_string(value) + ", ";
+        }
+
+        expected.resize(expected.size() - 2);
+        expected += "]";
+
+        std::string output;
+        container_printer::sinks::string_sink<char> sink{ output };
+        sink << vector;
+
+        REQUIRE(output == expected);
+    }
+
+    SECTION("Printing integers to a wide stream.")
+    {
+        const std::map<int, long> map{ { -1, 100000L }, { 2, -3L } };
+
+        std::wostringstream stream;
+        stream << map;
+
+        REQUIRE(stream.str() == L"[(-1, 100000), (2, -3)]");
+    }
+
+    SECTION("Stream flags are honoured in the automatic mode.")
+    {
+        const std::vector<int> vector{ 10, 255 };
+
+        std::ostringstream stream;
+        stream << std::hex << std::showbase << vector;
+
+        REQUIRE(stream.str() == "[0xa, 0xff]");
+    }
+
+    SECTION("Stream flags are ignored in the locale-free mode.")
+    {
+        const std::vector<int> vector{ 10, 255 };
+
+        std::ostringstream stream;
+        stream << std::hex
+               << container_printer::with_options(
+                      vector, { container_printer::integer_format::locale_free });
+
+        REQUIRE(stream.str() == "[10, 255]");
+    }
+
+    SECTION("Stream flags are honoured in the stream mode, including for std::tuple<...>.")
+    {
+        const auto tuple = std::make_tuple(10, std::make_pair(11, 12));
+
+        std::ostringstream stream;
+        stream << std::hex
+               << container_printer::with_options(
+                      tuple, { container_printer::integer_format::stream });
+
+        REQUIRE(stream.str() == "<a, (b, c)>");
+    }
+}
+
+TEST_CASE("Printing of Floating-Point Numbers")
+{
+    const std::vector<double> vector{ 0.1, 1.0 / 3.0, 1e300, -2.5, 123456789.0, 0.0 };
+
+    SECTION("The automatic mode matches the stream's default output.")
+    {
+        std::ostringstream stream;
+        stream << vector;
+
+        REQUIRE(stream.str() == print_unbuffered(vector));
+        REQUIRE(stream.str() == "[0.1, 0.333333, 1e+300, -2.5, 1.23457e+08, 0]");
+    }
+
+    SECTION("The automatic mode honours the stream's precision and flags.")
+    {
+        const std::vector<double> subset{ 0.1, 1.0 / 3.0, -2.5 };
+
+        std::ostringstream general;
+        general << std::setprecision(3) << subset;
+
+        REQUIRE(general.str() == "[0.1, 0.333, -2.5]");
+
+        std::ostringstream fixed;
+        fixed << std::setprecision(3) << std::fixed << subset;
+
+        REQUIRE(fixed.str() == "[0.100, 0.333, -2.500]");
+    }
+
+    SECTION("Printing the shortest round-trip representation.")
+    {
+        container_printer::format_options options;
+        options.floats = container_printer::float_format::shortest;
+
+        std::ostringstream stream;
+        stream << container_printer::with_options(vector, options);
+
+        REQUIRE(stream.str() == "[0.1, 0.3333333333333333, 1e+300, -2.5, 123456789, 0]");
+    }
+
+    SECTION("Printing a fixed number of decimals, to a wide stream.")
+    {
+        container_printer::format_options options;
+        options.floats = container_printer::float_format::fixed;
+        options.float_precision = 2;
+
+        const std::pair<float, double> pair{ 0.125f, -1e20 };
+
+        std::wostringstream stream;
+        stream << container_printer::with_options(pair, options);
+
+        REQUIRE(stream.str() == L"(0.12, -100000000000000000000.00)");
+    }
+
+    SECTION("Printing very large values with a fixed number of decimals.")
+    {
+        container_printer::format_options options;
+        options.floats = container_printer::float_format::fixed;
+        options.float_precision = 1;
+
+        const std::vector<double> large{ 1e300 };
+
+        std::ostringstream stream;
+        stream << container_printer::with_options(large, options);
+
+        REQUIRE(stream.str().size() == 1 + 301 + 2 + 1);
+        REQUIRE(stream.str().substr(stream.str().size() - 3) == ".0]");
+    }
+}
+
+namespace
+{
+/**
+ * @brief A container whose compile-time separator is `SeparatorLength` dashes long, which may be
+ * more than fits in the blocks that the kernels write through.
+ */
+template <typename ContainerType, std::size_t SeparatorLength>
+struct widely_separated : public ContainerType
+{
+    using ContainerType::ContainerType;
+};
+
+template <std::size_t Length> constexpr std::array<char, Length> make_dashes()
+{
+    std::array<char, Length> dashes{};
+    for (auto& dash : dashes) {
+        dash = '-';
+    }
+
+    return dashes;
+}
+
+template <std::size_t Length> constexpr auto dashes_v = make_dashes<Length>();
+} // namespace
+
+template <typename ContainerType, std::size_t SeparatorLength>
+struct container_printer::decorator::delimiters<
+    widely_separated<ContainerType, SeparatorLength>, char>
+{
+    static constexpr wrapper<char> values = {
+        "[", { dashes_v<SeparatorLength>.data(), SeparatorLength }, "]"
+    };
+};
+
+TEST_CASE("Printing of Contiguous Containers")
+{
+    SECTION("Printing a large std::vector<std::int64_t> that spans many blocks.")
+    {
+        std::vector<std::int64_t> vector(100'000);
+        std::iota(std::begin(vector), std::end(vector), std::numeric_limits<std::int64_t>::min());
+
+        std::ostringstream stream;
+        stream << vector;
+
+        REQUIRE(stream.str() == print_unbuffered(vector));
+    }
+
+    SECTION("Separators too long to share a block with the elements are written on their own.")
+    {
+        const widely_separated<std::vector<int>, 1'200> shorter(64, -123456789);
+        const widely_separated<std::vector<std::int64_t>, 10'000> longer(3, 1234567890123);
+        const widely_separated<std::vector<double>, 10'000> floats{ 0.5, 1.5, 2.5 };
+
+        std::ostringstream stream;
+        stream << shorter;
+        REQUIRE(stream.str().size() == 2 + 64 * 10 + 63 * 1'200);
+        REQUIRE(stream.str() == print_unbuffered(shorter));
+
+        REQUIRE(container_printer::to_string(longer) == print_unbuffered(longer));
+        REQUIRE(container_printer::to_string(floats) == print_unbuffered(floats));
+    }
+
+    SECTION("Printing a large std::vector<double> that spans many blocks.")
+    {
+        std::vector<double> vector(50'000);
+        for (std::size_t index = 0; index < vector.size(); ++index) {
+            vector[index] = static_cast<double>(index) / 7.0 - 1000.0;
+        }
+
+        std::ostringstream stream;
+        stream << std::setprecision(12) << vector;
+
+        REQUIRE(stream.str() == print_unbuffered(vector, 12));
+    }
+
+    SECTION("Printing a std::array<...> to a wide stream.")
+    {
+        const std::array<unsigned short, 3> array{ 1, 65535, 0 };
+
+        std::wostringstream stream;
+        stream << array;
+
+        REQUIRE(stream.str() == L"[1, 65535, 0]");
+    }
+
+    SECTION("Printing an array of floats in the shortest mode.")
+    {
+        const float array[3] = { 0.1f, 2.5f, -1e-10f };
+
+        container_printer::format_options options;
+        options.floats = container_printer::float_format::shortest;
+
+        std::ostringstream stream;
+        stream << container_printer::with_options(array, options);
+
+        REQUIRE(stream.str() == "[0.1, 2.5, -1e-10]");
+    }
+
+    SECTION("Printing an empty std::vector<...>.")
+    {
+        const std::vector<int> vector;
+
+        std::string output;
+        container_printer::sinks::string_sink<char> sink{ output };
+        sink << vector;
+
+        REQUIRE(output == "[]");
+    }
+
+    SECTION("Stream flags still fall back to the per-element path.")
+    {
+        const std::vector<int> vector{ 255, 16 };
+
+        std::ostringstream stream;
+        stream << std::hex << vector;
+
+        REQUIRE(stream.str() == "[ff, 10]");
+    }
+}
+
+TEST_CASE("Batch Conversion of Integers")
+{
+    using container_printer::detail::simd::instruction_set;
+
+    const auto print_with = [](const auto& vector, instruction_set set) {
+        std::string output;
+        container_printer::sinks::string_sink<char> sink{ output };
+        container_printer::detail::write_contiguous(
+            sink, vector.data(), vector.size(), ", ", container_printer::detail::float_spec{},
+            set);
+
+        return output;
+    };
+
+    const auto expected_output = [](const auto& vector) {
+        std::string expected;
+        for (const auto value : vector) {
+            expected += (expected.empty() ? "" : ", ") + std::to_string(value);
+        }
+
+        return expected;
+    };
+
+    std::vector<instruction_set> sets = { instruction_set::scalar };
+    if (container_printer::detail::simd::active_instruction_set() != instruction_set::scalar) {
+        sets.push_back(instruction_set::sse41);
+    }
+
+    if (container_printer::detail::simd::active_instruction_set() == instruction_set::avx2) {
+        sets.push_back(instruction_set::avx2);
+    }
+
+    SECTION("Converting 32-bit integers around every power of ten.")
+    {
+        std::vector<std::int32_t> signed_values{ std::numeric_limits<std::int32_t>::min(),
+                                                 std::numeric_limits<std::int32_t>::max() };
+
+        std::vector<std::uint32_t> unsigned_values{ std::numeric_limits<std::uint32_t>::max() };
+
+        for (std::int64_t power = 1; power <= 1'000'000'000; power *= 10) {
+            for (const auto value : { power - 1, power, power + 1 }) {
+                signed_values.push_back(static_cast<std::int32_t>(value));
+                signed_values.push_back(static_cast<std::int32_t>(-value));
+                unsigned_values.push_back(static_cast<std::uint32_t>(value));
+                unsigned_values.push_back(static_cast<std::uint32_t>(value * 4));
+            }
+        }
+
+        for (const auto set : sets) {
+            REQUIRE(print_with(signed_values, set) == expected_output(signed_values));
+            REQUIRE(print_with(unsigned_values, set) == expected_output(unsigned_values));
+        }
+    }
+
+    SECTION("Converting random 64-bit integers, both small and full-range.")
+    {
+        std::mt19937_64 generator{ 42 };
+        std::uniform_int_distribution<std::int64_t> full_range;
+        std::uniform_int_distribution<std::int64_t> small_range{ -5'000'000'000, 5'000'000'000 };
+
+        std::vector<std::int64_t> values(10'000);
+        for (std::size_t index = 0; index < values.size(); ++index) {
+            values[index] = index % 16 == 0 ? full_range(generator) : small_range(generator);
+        }
+
+        for (const auto set : sets) {
+            REQUIRE(print_with(values, set) == expected_output(values));
+        }
+    }
+}
+
+TEST_CASE("Parallel Printing of Contiguous Containers")
+{
+    container_printer::format_options options;
+    options.parallel.thread_count = 4;
+    options.parallel.chunk_size = 10'000;
+    options.parallel.threshold = 0;
+
+    SECTION("Printing a large std::vector<std::uint32_t> matches the serial output.")
+    {
+        std::vector<std::uint32_t> vector(1'000'003);
+        std::iota(std::begin(vector), std::end(vector), 4'000'000'000u);
+
+        std::ostringstream serial;
+        serial << vector;
+
+        std::ostringstream parallel;
+        parallel << container_printer::with_options(vector, options);
+
+        REQUIRE(parallel.str() == serial.str());
+    }
+
+    SECTION("Printing a std::vector<double> honours the stream's precision.")
+    {
+        std::vector<double> vector(25'000);
+        for (std::size_t index = 0; index < vector.size(); ++index) {
+            vector[index] = static_cast<double>(index) / 3.0;
+        }
+
+        std::wostringstream serial;
+        serial << std::setprecision(10) << vector;
+
+        std::wostringstream parallel;
+        parallel << std::setprecision(10) << container_printer::with_options(vector, options);
+
+        REQUIRE(parallel.str() == serial.str());
+    }
+
+    SECTION("Printing a container smaller than the threshold.")
+    {
+        options.parallel.threshold = 1'000;
+
+        const std::array<int, 3> array{ 1, 2, 3 };
+
+        std::ostringstream stream;
+        stream << container_printer::with_options(array, options);
+
+        REQUIRE(stream.str() == "[1, 2, 3]");
+    }
+
+    SECTION("Printing with as many threads as the hardware supports.")
+    {
+        options.parallel.thread_count = 0;
+
+        const std::vector<int> vector(100'000, -7);
+
+        std::string expected;
+        container_printer::sinks::string_sink<char> serial_sink{ expected };
+        serial_sink << vector;
+
+        std::string output;
+        container_printer::sinks::string_sink<char> sink{ output };
+        container_printer::to_stream(
+            sink, vector,
+            container_printer::default_formatter<std::vector<int>, decltype(sink)>{ options });
+
+        REQUIRE(output == expected);
+    }
+}
+
+namespace
+{
+/**
+ * @brief A type whose output operator records the thread that it was printed on, and that takes
+ * long enough to print that the other threads of a parallel traversal will pick up some of the
+ * work.
+ */
+struct thread_recorder
+{
+};
+
+std::mutex recorded_threads_mutex;
+std::set<std::thread::id> recorded_threads;
+
+std::ostream& operator<<(std::ostream& stream, const thread_recorder&)
+{
+    std::this_thread::sleep_for(std::chrono::microseconds{ 200 });
+
+    const std::lock_guard<std::mutex> lock{ recorded_threads_mutex };
+    recorded_threads.insert(std::this_thread::get_id());
+
+    return stream << '*';
+}
+} // namespace
+
+TEST_CASE("Parallel Printing of Nested Containers")
+{
+    container_printer::format_options options;
+    options.parallel.thread_count = 4;
+    options.parallel.chunk_size = 1'000;
+    options.parallel.threshold = 0;
+    options.parallel.task_size = 500;
+
+    SECTION("Printing a std::map<...> of unevenly sized std::vector<...>s.")
+    {
+        std::map<std::string, std::vector<int>> map;
+        for (int key = 0; key < 200; ++key) {
+            std::vector<int> values(static_cast<std::size_t>((key * 37) % 1'500));
+            std::iota(std::begin(values), std::end(values), -key);
+            map.emplace("key " + std::to_string(key), std::move(values));
+        }
+
+        std::ostringstream serial;
+        serial << map;
+
+        std::ostringstream parallel;
+        parallel << container_printer::with_options(map, options);
+
+        REQUIRE(parallel.str() == serial.str());
+    }
+
+    SECTION("Printing a std::vector<...> of std::vector<double>s nested three deep.")
+    {
+        std::vector<std::vector<std::vector<double>>> vector(12);
+        for (std::size_t outer = 0; outer < vector.size(); ++outer) {
+            vector[outer].resize(outer * 10);
+            for (std::size_t inner = 0; inner < vector[outer].size(); ++inner) {
+                vector[outer][inner].assign(inner * 7, static_cast<double>(outer) / 7.0);
+            }
+        }
+
+        std::wostringstream serial;
+        serial << std::setprecision(12) << vector;
+
+        std::wostringstream parallel;
+        parallel << std::setprecision(12) << container_printer::with_options(vector, options);
+
+        REQUIRE(parallel.str() == serial.str());
+    }
+
+    SECTION("Printing node-based containers.")
+    {
+        std::list<std::tuple<int, std::string, std::set<int>>> list;
+        for (int index = 0; index < 5'000; ++index) {
+            std::set<int> set;
+            for (int element = 0; element < index % 700; ++element) {
+                set.insert(element * index);
+            }
+
+            list.emplace_back(index, "item", std::move(set));
+        }
+
+        std::ostringstream serial;
+        serial << list;
+
+        std::ostringstream parallel;
+        parallel << container_printer::with_options(list, options);
+
+        REQUIRE(parallel.str() == serial.str());
+    }
+
+    SECTION("Stream flags apply to the elements formatted on other threads.")
+    {
+        const std::vector<std::vector<int>> vector(20, std::vector<int>(900, 255));
+
+        std::ostringstream serial;
+        serial << std::hex << std::showbase << vector;
+
+        std::ostringstream parallel;
+        parallel << std::hex << std::showbase << container_printer::with_options(vector, options);
+
+        REQUIRE(parallel.str() == serial.str());
+        REQUIRE(parallel.str().find("0xff") != std::string::npos);
+    }
+
+    SECTION("Elements are only weighed up to the task size.")
+    {
+        using container_printer::detail::weight;
+
+        const std::vector<std::vector<int>> vector(1'000, std::vector<int>(10));
+
+        REQUIRE(weight(vector) == 10'000);
+        REQUIRE(weight(vector, 25) == 30);
+        REQUIRE(weight(std::make_tuple(vector, vector), 10'005) == 10'010);
+    }
+
+    SECTION("Elements are formatted on other threads, whichever engine prints the container.")
+    {
+        options.parallel.task_size = 10;
+
+        const std::vector<std::vector<thread_recorder>> vector(
+            40, std::vector<thread_recorder>(25));
+
+        recorded_threads.clear();
+
+        std::ostringstream parallel;
+        parallel << container_printer::with_options(vector, options);
+
+        REQUIRE(parallel.str().size() == 2 + 40 * (2 + 25 * 3 - 2) + 39 * 2);
+        REQUIRE(recorded_threads.size() > 1);
+    }
+
+    SECTION("Printing a nested container smaller than the threshold.")
+    {
+        options.parallel.threshold = 1'000;
+
+        const std::vector<std::vector<int>> vector{ { 1, 2 }, {}, { 3 } };
+
+        std::ostringstream stream;
+        stream << container_printer::with_options(vector, options);
+
+        REQUIRE(stream.str() == "[[1, 2], [], [3]]");
+    }
+}
+
+namespace
+{
+/**
+ * @brief A string buffer that serializes, and counts, every write that is made to it.
+ */
+class locked_buffer : public std::stringbuf
+{
+  public:
+    std::size_t write_count() const
+    {
+        return m_write_count;
+    }
+
+  protected:
+    std::streamsize xsputn(const char* data, std::streamsize size) override
+    {
+        const std::lock_guard<std::recursive_mutex> lock{ m_mutex };
+        ++m_write_count;
+
+        // The base implementation may call overflow(...), which is still part of this write.
+        m_is_writing = true;
+        const auto written = std::stringbuf::xsputn(data, size);
+        m_is_writing = false;
+
+        return written;
+    }
+
+    int_type overflow(int_type character) override
+    {
+        const std::lock_guard<std::recursive_mutex> lock{ m_mutex };
+        if (!m_is_writing) {
+            ++m_write_count;
+        }
+
+        return std::stringbuf::overflow(character);
+    }
+
+  private:
+    std::recursive_mutex m_mutex;
+    std::size_t m_write_count = 0;
+    bool m_is_writing = false;
+};
+
+/**
+ * @brief A type whose own output operator prints a container atomically.
+ */
+struct widget
+{
+    std::vector<int> parts;
+};
+
+std::ostream& operator<<(std::ostream& stream, const widget& widget)
+{
+    container_printer::format_options options;
+    options.atomic_write = true;
+
+    return stream << "widget" << container_printer::with_options(widget.parts, options);
+}
+
+/**
+ * @brief A type whose output operator switches the stream to hexadecimal, and leaves it that way.
+ */
+struct careless_hex
+{
+    int value;
+};
+
+std::ostream& operator<<(std::ostream& stream, const careless_hex& wrapper)
+{
+    return stream << std::hex << std::showbase << wrapper.value;
+}
+
+/**
+ * @brief A type whose output operator relies on the stream's default state.
+ */
+struct plain_value
+{
+    int value;
+};
+
+std::ostream& operator<<(std::ostream& stream, const plain_value& wrapper)
+{
+    return stream << wrapper.value;
+}
+
+/**
+ * @brief A type whose output operator converts a container to a string of its own.
+ */
+struct nested_text
+{
+    std::vector<int> values;
+};
+
+std::ostream& operator<<(std::ostream& stream, const nested_text& wrapper)
+{
+    return stream << container_printer::to_string_view(wrapper.values);
+}
+} // namespace
+
+TEST_CASE("Atomic Printing")
+{
+    container_printer::format_options options;
+    options.atomic_write = true;
+
+    SECTION("Printing a nested container in a single write.")
+    {
+        const std::map<int, std::vector<std::string>> map{ { 1, { "a", "b" } }, { 2, {} } };
+
+        locked_buffer buffer;
+        std::ostream stream{ &buffer };
+        stream << container_printer::with_options(map, options);
+
+        REQUIRE(buffer.str() == "[(1, [a, b]), (2, [])]");
+        REQUIRE(buffer.write_count() == 1);
+    }
+
+    SECTION("Printing a large container matches the default output.")
+    {
+        std::vector<std::pair<int, double>> vector(10'000);
+        for (std::size_t index = 0; index < vector.size(); ++index) {
+            vector[index] = { static_cast<int>(index), static_cast<double>(index) / 9.0 };
+        }
+
+        std::ostringstream expected;
+        expected << std::hex << std::setprecision(4) << vector;
+
+        locked_buffer buffer;
+        std::ostream stream{ &buffer };
+        stream << std::hex << std::setprecision(4)
+               << container_printer::with_options(vector, options);
+
+        REQUIRE(buffer.str() == expected.str());
+        REQUIRE(buffer.write_count() == 1);
+    }
+
+    SECTION("Concurrent threads don't interleave their output.")
+    {
+        constexpr int thread_count = 4;
+        constexpr int line_count = 200;
+
+        locked_buffer buffer;
+        std::ostream stream{ &buffer };
+
+        std::vector<std::thread> threads;
+        for (int thread = 0; thread < thread_count; ++thread) {
+            threads.emplace_back([&, thread] {
+                const std::vector<int> line(50, thread);
+                for (int index = 0; index < line_count; ++index) {
+                    stream << container_printer::with_options(line, options);
+                }
+            });
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        std::vector<std::string> expected_lines;
+        for (int thread = 0; thread < thread_count; ++thread) {
+            std::ostringstream line;
+            line << std::vector<int>(50, thread);
+            expected_lines.push_back(line.str());
+        }
+
+        const auto output = buffer.str();
+        std::size_t position = 0;
+        std::size_t lines_found = 0;
+
+        while (position < output.size()) {
+            const auto match = std::find_if(
+                std::begin(expected_lines), std::end(expected_lines),
+                [&](const std::string& line) {
+                    return output.compare(position, line.size(), line) == 0;
+                });
+
+            REQUIRE(match != std::end(expected_lines));
+
+            position += match->size();
+            ++lines_found;
+        }
+
+        REQUIRE(lines_found == thread_count * line_count);
+        REQUIRE(buffer.write_count() == thread_count * line_count);
+    }
+
+    SECTION("An element that prints a container of its own doesn't clobber the buffer.")
+    {
+        const std::vector<widget> widgets{ { { 1, 2 } }, { {} }, { { 3 } } };
+
+        std::ostringstream stream;
+        stream << container_printer::with_options(widgets, options);
+
+        REQUIRE(stream.str() == "[widget[1, 2], widget[], widget[3]]");
+    }
+}
+
+TEST_CASE("Converting to Strings")
+{
+    SECTION("Converting a populated std::vector<...>.")
+    {
+        const std::vector<int> vector{ 1, 2, 3, 4 };
+
+        REQUIRE(container_printer::to_string(vector) == "[1, 2, 3, 4]");
+    }
+
+    SECTION("Converting a nested container to a wide string, with options.")
+    {
+        const std::map<int, std::vector<double>> map{ { 1, { 0.5, 1.0 / 3.0 } }, { 2, {} } };
+
+        container_printer::format_options options;
+        options.floats = container_printer::float_format::fixed;
+        options.float_precision = 2;
+
+        REQUIRE(
+            container_printer::to_string<wchar_t>(map, options) ==
+            L"[(1, [0.50, 0.33]), (2, [])]");
+    }
+
+    SECTION("Converting with a custom formatter.")
+    {
+        const auto container = std::make_tuple(1, 2, 3, 4);
+
+        REQUIRE(
+            container_printer::to_string<wchar_t>(container, custom_formatter{}) ==
+            L"$$ 1 | 2 | 3 | 4 $$");
+    }
+
+    SECTION("Consecutive conversions don't see each other's output.")
+    {
+        const auto first = container_printer::to_string(std::vector<int>(1'000, 7));
+        const auto second = container_printer::to_string(std::set<int>{ 1 });
+
+        REQUIRE(first.size() == 1 + 1'000 * 3 - 2 + 1);
+        REQUIRE(second == "{1}");
+    }
+
+    SECTION("Converting to a view into the thread-local buffer.")
+    {
+        const std::list<std::string> list{ "alpha", "beta" };
+
+        const auto view = container_printer::to_string_view(list);
+        REQUIRE(view == "[alpha, beta]");
+
+        const auto next_view = container_printer::to_string_view(std::vector<int>{});
+        REQUIRE(next_view == "[]");
+    }
+
+    SECTION("A conversion that outgrows the retained capacity is still viewed in full.")
+    {
+        const std::vector<int> vector(400'000, 7);
+
+        const auto view = container_printer::to_string_view(vector);
+        REQUIRE(view.size() == 1 + 400'000 * 3 - 2 + 1);
+        REQUIRE(view.substr(view.size() - 4) == ", 7]");
+
+        REQUIRE(container_printer::to_string_view(std::set<int>{ 1 }) == "{1}");
+    }
+
+    SECTION("Elements printed through their own operator<< start from the default state.")
+    {
+        const std::vector<std::pair<careless_hex, plain_value>> vector{ { { 255 }, { 255 } },
+                                                                        { { 16 }, { 16 } } };
+
+        REQUIRE(container_printer::to_string(vector) == "[(0xff, 255), (0x10, 16)]");
+    }
+
+    SECTION("Elements that convert containers of their own.")
+    {
+        const std::vector<nested_text> vector{ { { 1, 2 } }, { {} } };
+
+        REQUIRE(container_printer::to_string_view(vector) == "[[1, 2], []]");
+    }
+}
+
+TEST_CASE("Formatting into Fixed Buffers")
+{
+    SECTION("Formatting a nested container into a buffer that is large enough.")
+    {
+        const std::map<int, std::vector<double>> map{ { 1, { 0.5, 2.0 } }, { 2, {} } };
+        const std::tuple<int, const char*, std::string> tuple{ 1, "two", "three" };
+
+        char buffer[64];
+
+        const auto map_result = container_printer::format_to(buffer, map);
+        REQUIRE(map_result.truncated == false);
+        REQUIRE(std::string_view{ buffer, map_result.written } == "[(1, [0.5, 2]), (2, [])]");
+
+        const auto tuple_result = container_printer::format_to(buffer, sizeof(buffer), tuple);
+        REQUIRE(std::string_view{ buffer, tuple_result.written } == "<1, two, three>");
+    }
+
+    SECTION("Formatting a large contiguous container into a small buffer.")
+    {
+        const std::vector<std::int64_t> vector(10'000, -1234567890123);
+
+        wchar_t buffer[32];
+
+        const auto result = container_printer::format_to(buffer, vector);
+        REQUIRE(result.truncated == true);
+        REQUIRE(result.written == 32);
+        REQUIRE(result.size == 2 + 10'000 * 14 + 9'999 * 2);
+        REQUIRE(std::wstring_view{ buffer, result.written } == L"[-1234567890123, -1234567890123,");
+    }
+
+    SECTION("Only containers of allocation-free elements are accepted.")
+    {
+        using container_printer::detail::is_allocation_free_v;
+
+        STATIC_REQUIRE(is_allocation_free_v<std::vector<std::pair<int, std::string>>, char>);
+        STATIC_REQUIRE(is_allocation_free_v<std::set<std::tuple<float, char>>, char>);
+        STATIC_REQUIRE(is_allocation_free_v<std::wstring, wchar_t>);
+        STATIC_REQUIRE_FALSE(is_allocation_free_v<std::vector<bool>, char>);
+        STATIC_REQUIRE_FALSE(is_allocation_free_v<std::list<std::wstring>, char>);
+        STATIC_REQUIRE_FALSE(is_allocation_free_v<std::vector<widget>, char>);
+    }
+}
+
+TEST_CASE("Measuring the Formatted Size")
+{
+    SECTION("Measuring integers of every length, including the extremes.")
+    {
+        std::vector<std::int64_t> vector{ 0, -1, std::numeric_limits<std::int64_t>::min(),
+                                          std::numeric_limits<std::int64_t>::max() };
+
+        for (std::int64_t power = 1; power < 1'000'000'000'000'000'000; power *= 10) {
+            vector.insert(std::end(vector), { power - 1, power, -power, -(power - 1) });
+        }
+
+        REQUIRE(
+            container_printer::formatted_size(vector) ==
+            container_printer::to_string(vector).size());
+
+        const std::list<std::uint64_t> list{ 9, 10, std::numeric_limits<std::uint64_t>::max() };
+        REQUIRE(
+            container_printer::formatted_size(list) == container_printer::to_string(list).size());
+    }
+
+    SECTION("Measuring nested containers of mixed elements.")
+    {
+        const std::map<std::string, std::tuple<int, double, bool, widget>> map{
+            { "first", { -17, 0.1, true, { { 1, 2 } } } }, { "second", { 0, 1e300, false, {} } }
+        };
+
+        REQUIRE(container_printer::formatted_size(map) == container_printer::to_string(map).size());
+    }
+
+    SECTION("Measuring with options, with a custom formatter, and in wide characters.")
+    {
+        const std::vector<double> vector{ 1.0 / 3.0, 2.5, -1e-7 };
+
+        container_printer::format_options options;
+        options.floats = container_printer::float_format::fixed;
+        options.float_precision = 3;
+
+        REQUIRE(
+            container_printer::formatted_size<wchar_t>(vector, options) ==
+            container_printer::to_string<wchar_t>(vector, options).size());
+
+        REQUIRE(
+            container_printer::formatted_size<wchar_t>(vector, custom_formatter{}) ==
+            container_printer::to_string<wchar_t>(vector, custom_formatter{}).size());
+    }
+}
+
+TEST_CASE("Printing of Bounded Elements")
+{
+    SECTION("The bound is computed at compile time.")
+    {
+        using container_printer::detail::max_formatted_length;
+
+        STATIC_REQUIRE(max_formatted_length<std::int32_t, char>() == 11);
+        STATIC_REQUIRE(max_formatted_length<std::pair<int, int>, char>() == 11 + 11 + 4);
+        STATIC_REQUIRE(
+            max_formatted_length<std::tuple<std::uint16_t, std::int16_t>, wchar_t>() == 6 + 6 + 4);
+        STATIC_REQUIRE(
+            max_formatted_length<std::array<std::uint16_t, 3>, char>() == 3 * 6 + 2 * 2 + 2);
+        STATIC_REQUIRE(max_formatted_length<std::tuple<>, char>() == 2);
+        STATIC_REQUIRE(max_formatted_length<std::pair<int, double>, char>() == 0);
+        STATIC_REQUIRE(max_formatted_length<std::vector<int>, char>() == 0);
+    }
+
+    SECTION("Printing a std::vector<std::pair<...>> at the extremes.")
+    {
+        using limits = std::numeric_limits<std::int64_t>;
+
+        std::vector<std::pair<std::int64_t, std::uint16_t>> vector;
+        for (std::size_t index = 0; index < 5'000; ++index) {
+            const auto value = index % 2 == 0 ? limits::min() : limits::max();
+            vector.emplace_back(value, static_cast<std::uint16_t>(index));
+        }
+
+        const auto expected = print_unbuffered(vector);
+
+        std::ostringstream stream;
+        stream << vector;
+        REQUIRE(stream.str() == expected);
+
+        REQUIRE(container_printer::to_string(vector) == expected);
+    }
+
+    SECTION("Separators too long to share a block with the elements are written on their own.")
+    {
+        const widely_separated<std::vector<std::pair<int, int>>, 1'200> shorter(64, { -1, 2 });
+        const widely_separated<std::vector<std::tuple<std::int64_t>>, 10'000> longer(3, { -7 });
+
+        std::ostringstream stream;
+        stream << shorter;
+        REQUIRE(stream.str() == print_unbuffered(shorter));
+
+        std::ostringstream long_stream;
+        long_stream << longer;
+        REQUIRE(long_stream.str().size() == 2 + 3 * 4 + 2 * 10'000);
+        REQUIRE(long_stream.str() == print_unbuffered(longer));
+    }
+
+    SECTION("Printing node-based containers of tuples and arrays.")
+    {
+        std::map<std::int16_t, std::array<std::uint16_t, 3>> map;
+        std::list<std::tuple<int, unsigned, std::tuple<>>> list;
+
+        for (int index = -1'000; index < 1'000; ++index) {
+            const auto value = static_cast<std::uint16_t>(index * 37);
+            map[static_cast<std::int16_t>(index * 17)] = { value, 0, 65'535 };
+            list.emplace_back(index, static_cast<unsigned>(index), std::tuple<>{});
+        }
+
+        std::ostringstream map_stream;
+        map_stream << map;
+        REQUIRE(map_stream.str() == print_unbuffered(map));
+
+        std::ostringstream list_stream;
+        list_stream << list;
+        REQUIRE(list_stream.str() == print_unbuffered(list));
+    }
+
+    SECTION("Printing to a wide string, and to a buffer that is too small.")
+    {
+        const std::set<std::pair<int, int>> set{ { 1, -2 }, { 3, 4 } };
+
+        std::wstring output = L"> ";
+        container_printer::sinks::string_sink<wchar_t> sink{ output };
+        sink << set;
+
+        REQUIRE(output == L"> {(1, -2), (3, 4)}");
+
+        char buffer[8];
+        const auto result = container_printer::format_to(buffer, set);
+
+        REQUIRE(result.truncated == true);
+        REQUIRE(result.size == std::string_view{ "{(1, -2), (3, 4)}" }.size());
+        REQUIRE(std::string_view{ buffer, result.written } == "{(1, -2)");
+    }
+
+    SECTION("Stream flags still fall back to the per-element path.")
+    {
+        const std::vector<std::pair<int, int>> vector{ { 10, 11 } };
+
+        std::ostringstream stream;
+        stream << std::hex << vector;
+
+        REQUIRE(stream.str() == "[(a, b)]");
+    }
+}
+
+namespace
+{
+constexpr std::array<std::pair<int, const char*>, 3> error_codes{
+    { { 404, "Not Found" }, { 500, "Internal Server Error" }, { -1, "Unknown" } }
+};
+
+constexpr std::tuple<std::int64_t, char, std::array<unsigned, 2>, std::tuple<>> defaults{
+    std::numeric_limits<std::int64_t>::min(), 'x', { 0, 4'294'967'295u }, {}
+};
+
+constexpr std::array<int, 0> nothing{};
+} // namespace
+
+TEST_CASE("Printing with Fused Delimiters")
+{
+    SECTION("The delimiters between fields are fused at compile time.")
+    {
+        using fused_type = container_printer::detail::fused_delimiters<
+            std::vector<std::pair<std::string, std::tuple<int, std::string>>>, char>;
+
+        STATIC_REQUIRE(fused_type::fields == 3);
+        STATIC_REQUIRE(fused_type::runs.run(0) == std::string_view{ "[(" });
+        STATIC_REQUIRE(fused_type::runs.run(1) == std::string_view{ ", <" });
+        STATIC_REQUIRE(fused_type::runs.run(2) == std::string_view{ ", " });
+        STATIC_REQUIRE(fused_type::runs.run(3) == std::string_view{ ">), (" });
+        STATIC_REQUIRE(fused_type::runs.run(4) == std::string_view{ ">)]" });
+    }
+
+    SECTION("Printing a std::map<...> with nested pairs and tuples.")
+    {
+        const std::map<std::string, std::pair<int, std::tuple<std::string, double>>> map{
+            { "a", { 1, { "x", 0.5 } } }, { "b", { 2, { "y", 1.5 } } }
+        };
+
+        const std::string expected = "[(a, (1, <x, 0.5>)), (b, (2, <y, 1.5>))]";
+
+        std::stringstream stream;
+        stream << map;
+
+        REQUIRE(stream.str() == expected);
+        REQUIRE(container_printer::to_string(map) == expected);
+        REQUIRE(container_printer::formatted_size(map) == expected.size());
+    }
+
+    SECTION("Printing a std::vector<...> of a single element, and of empty tuples.")
+    {
+        std::stringstream stream;
+        stream << std::vector<std::pair<std::string, int>>{ { "a", 1 } }
+               << std::vector<std::tuple<>>{ {}, {} } << std::map<int, std::string>{};
+
+        REQUIRE(stream.str() == "[(a, 1)][<>, <>][]");
+    }
+
+    SECTION("Runtime delimiters are not fused, but still apply.")
+    {
+        const std::map<std::string, int> map{ { "a", 1 }, { "b", 2 } };
+        const container_printer::decorator::delimiter_set delimiters{ "{", " ", "}" };
+
+        std::stringstream stream;
+        stream << container_printer::with_delimiters(map, delimiters);
+
+        REQUIRE(stream.str() == "{(a, 1) (b, 2)}");
+    }
+}
+
+TEST_CASE("Printing at Compile Time")
+{
+    SECTION("Formatting a table of codes, and printing it in a single write.")
+    {
+        constexpr auto& text = container_printer::static_text<error_codes>;
+
+        STATIC_REQUIRE(
+            text.view() == "[(404, Not Found), (500, Internal Server Error), (-1, Unknown)]");
+        STATIC_REQUIRE(text.size() == text.view().size());
+
+        std::ostringstream expected;
+        expected << error_codes;
+
+        locked_buffer buffer;
+        std::ostream stream{ &buffer };
+        stream << text;
+
+        REQUIRE(buffer.str() == expected.str());
+        REQUIRE(buffer.write_count() == 1);
+    }
+
+    SECTION("Formatting a tuple of mixed elements to a wide string.")
+    {
+        constexpr auto& text = container_printer::static_text<defaults, wchar_t>;
+
+        std::wostringstream expected;
+        expected << defaults;
+
+        REQUIRE(std::wstring{ text.c_str() } == expected.str());
+    }
+
+    SECTION("Formatting a table of codes to UTF-16.")
+    {
+        STATIC_REQUIRE(
+            container_printer::static_text<error_codes, char16_t>.view() ==
+            u"[(404, Not Found), (500, Internal Server Error), (-1, Unknown)]");
+    }
+
+    SECTION("Formatting an empty container.")
+    {
+        STATIC_REQUIRE(container_printer::static_text<nothing>.view() == "[]");
+    }
+}
+
+namespace
+{
+template <std::size_t... Indices> auto make_wide_tuple(std::index_sequence<Indices...>)
+{
+    return std::make_tuple(static_cast<int>(Indices * 1'000)...);
+}
+} // namespace
+
+TEST_CASE("Printing of Wide Tuples")
+{
+    const auto tuple = make_wide_tuple(std::make_index_sequence<40>{});
+
+    std::string expected = "<";
+    for (int index = 0; index < 40; ++index) {
+        expected += (index == 0 ? "" : ", ") + std::to_string(index * 1'000);
+    }
+
+    expected += ">";
+
+    SECTION("Printing a std::tuple<...> of 40 elements.")
+    {
+        std::ostringstream stream;
+        stream << tuple;
+
+        REQUIRE(stream.str() == expected);
+    }
+
+    SECTION("Every element is routed through the formatter's options.")
+    {
+        container_printer::format_options options;
+        options.integers = container_printer::integer_format::locale_free;
+
+        std::ostringstream stream;
+        stream << std::hex << container_printer::with_options(tuple, options);
+
+        REQUIRE(stream.str() == expected);
+    }
+}
+
+#if defined(CONTAINER_PRINTER_HAS_FORMATTER)
+TEST_CASE("Printing with std::format")
+{
+    SECTION("Formatting a populated std::vector<...>.")
+    {
+        const std::vector<int> vector{ 1, 2, 3, 4 };
+
+        REQUIRE(std::format("{}", container_printer::fmt(vector)) == "[1, 2, 3, 4]");
+    }
+
+    SECTION("Formatting a nested container reuses the delimiters.")
+    {
+        const std::map<std::string, std::set<int>> map{ { "a", { 1, 2 } }, { "b", {} } };
+
+        REQUIRE(std::format("{}", container_printer::fmt(map)) == "[(a, {1, 2}), (b, {})]");
+    }
+
+    SECTION("The format spec is applied to every element.")
+    {
+        const std::vector<std::tuple<int, int>> vector{ { 10, 255 }, { 16, 0 } };
+
+        REQUIRE(
+            std::format("{:#x}", container_printer::fmt(vector)) == "[<0xa, 0xff>, <0x10, 0x0>]");
+    }
+
+    SECTION("Formatting into a preallocated buffer, and to a wide string.")
+    {
+        std::string buffer;
+        buffer.reserve(64);
+        const std::vector<int> ids{ 1, 22 };
+        std::format_to(std::back_inserter(buffer), "ids: {:>3}", container_printer::fmt(ids));
+
+        REQUIRE(buffer == "ids: [  1,  22]");
+        REQUIRE(std::format(L"{}", container_printer::fmt(std::list<int>{ 1, 2 })) == L"[1, 2]");
+    }
+}
+#endif